@@ -23,6 +23,7 @@ AigDef::AigDef() {
   NodeTbl.insert(Node1);
 
   indexCount = 1;
+  outputCount = 0;
 }
 
 AigDef::~AigDef() {
@@ -139,7 +140,70 @@ AigNode* AigDef::NewAndNode(AigNode* left, bool lpol, AigNode* right, bool rpol,
 }
 
 AigNode* AigDef::NewAndNode(AigNode* left, bool lpol, AigNode* right, bool rpol) {
-  this->NewAndNode(left, lpol, right, rpol, indexCount);
+  return this->NewAndNode(left, lpol, right, rpol, indexCount);
+}
+
+// edge to node, One() is folded into a complemented Zero()
+AigLit AigDef::NodeLit(AigNode* node) const {
+  AigLit lit;
+
+  if(node == Node1){
+    lit.node = Node0;
+    lit.pol = true;
+  }
+  else{
+    lit.node = node;
+    lit.pol = false;
+  }
+
+  return lit;
+}
+
+// 'and' of two edges, constants and trivial cases are folded
+AigLit AigDef::AndLit(AigLit left, AigLit right) {
+  AigLit res;
+  AigNode* node;
+  unsigned level;
+
+  if(left.node == Node0 && !left.pol)
+    return left;
+  if(right.node == Node0 && !right.pol)
+    return right;
+  if(left.node == Node0)
+    return right;
+  if(right.node == Node0)
+    return left;
+
+  if(left.node == right.node){
+    if(left.pol == right.pol)
+      return left;
+
+    res.node = Node0;
+    res.pol = false;
+    return res;
+  }
+
+  node = NewAndNode(left.node, left.pol, right.node, right.pol);
+
+  level = left.node->get_level();
+  if(right.node->get_level() > level)
+    level = right.node->get_level();
+  node->set_level(level + 1);
+
+  res.node = node;
+  res.pol = false;
+  return res;
+}
+
+// node computing an edge, complements get an 'and' with One()
+AigNode* AigDef::LitNode(AigLit lit) {
+  if(lit.node == Node0)
+    return lit.pol ? Node1 : Node0;
+
+  if(!lit.pol)
+    return lit.node;
+
+  return NewAndNode(lit.node, true, Node1, false);
 }
 
 bool AigDef::recursiveSim(AigNode* node, valMap &terminalValues, vector<AigNode*> &traversedNodes){
@@ -190,316 +254,6 @@ bool AigDef::recursiveSim(AigNode* node, valMap &terminalValues, vector<AigNode*
   }
 }
 
-void AigDef::sim(AigNode* function, vector<AigNode*> &latches, vector<AigNode*> &inputs, vector<AigNode*> &latchLogic, string inputFile, string outputFile){
-  bool nextState;
-  bool latchValues[(int)latches.size()];
-  int currentCycle = 0;
-  int latchIndex = 0;
-  char inputValue;
-  string line;
-  AigNode* latch, *nsFunction;
-  vector<AigNode*> traversedNodes;
-  valMap terminalValues;
-
-  // initialize latch values;
-  for(int i = 0; i< latches.size(); i++){
-    terminalValues[latches[i]->get_index()] = false;
-  }
-
-  if(!function){
-    cerr << "[aig.cc sim] NULL function node" << endl;
-    exit(1);
-  }
-  else if(function->is_const()){
-    cerr << "[aig.cc sim] function is constant" << endl;
-    return;
-  }
-  else if(function->is_input()){
-    cerr << "[aig.cc sim] function is input" << endl;
-    return;
-  }
-
-  ifstream in(inputFile.c_str(), ios::in);
-  if(!in.is_open()){
-    cerr << "Unable to open file " << inputFile << endl;
-    exit(1);
-  }
-
-  ofstream out(outputFile.c_str());
-    if(!out.is_open()){
-      cerr << "Unable to open file " << outputFile << endl;
-      exit(1);
-    }
-
-  while(true){
-    currentCycle++;
-
-    if(in.eof()){
-      break;
-    }
-
-    getline(in, line);
-
-    if(line.size()-1 != inputs.size()){
-      break;
-    }
-
-    const char* inputValues = line.c_str();
-
-    //set input values
-    for (int i = 0; i < inputs.size(); i++) {
-      if(inputValues[i] == '0'){
-        terminalValues[inputs[i]->get_index()] = false;
-        out << "0";
-      }
-      else if(inputValues[i] == '1'){
-        terminalValues[inputs[i]->get_index()] = true;
-        out << "1";
-      }
-      else{
-        cerr << "Invalid input value on line " << currentCycle << endl;
-        exit(1);
-      }
-    }
-
-    out << " ";
-    // for each latch sim cycle
-    for (int j = 0; j < latchLogic.size(); j++){
-      latch = latches[j];
-
-      if(terminalValues[latch->get_index()])
-        out << "1";
-      else
-        out << "0";
-
-      nextState = recursiveSim(latchLogic[j], terminalValues, traversedNodes);
-      for(int i = 0; i < traversedNodes.size(); i++){
-        traversedNodes[i]->set_dependence(NOTSET);
-      }
-      traversedNodes.clear();
-
-      if(latch->get_rpol())
-        nextState ? nextState = false : nextState = true;
-
-      latchValues[j] = nextState;
-    }
-
-
-    // set latch current state value
-    latchIndex = 0;
-    for(int i = 0; i < latches.size(); i++){
-      terminalValues[latches[i]->get_index()] = latchValues[i];
-    }
-
-    out << " " << recursiveSim(function, terminalValues, traversedNodes) << endl;
-    for(int i = 0; i < traversedNodes.size(); i++){
-      traversedNodes[i]->set_dependence(NOTSET);
-    }
-    traversedNodes.clear();
-  }
-
-  in.close();
-  out.close();
-}
-//
-//void AigDef::sim(AigNode* function, unsigned cycles, NodeMap &latches, NodeMap &inputs, ostream &out){
-//  bool nextState;
-//  bool latchValues[(int)latches.size()];
-//  int currentCycle = 0;
-//  int latchIndex = 0;
-//  AigNode* latch, *nsFunction;
-//  vector<AigNode*> traversedNodes;
-//  NodeMap::iterator it;
-//
-//  if(!function){
-//    cerr << "[aig.cc state_space_traversal] NULL function node" << endl;
-//    exit(1);
-//  }
-//  else if(function->is_const()){
-//    out << "[aig.cc state_space_traversal] function is constant" << endl;
-//    return;
-//  }
-//  else if(function->is_input()){
-//    out << "[aig.cc state_space_traversal] function is input" << endl;
-//    return;
-//  }
-//
-//  srand((unsigned)time(0));
-//
-//  while(currentCycle < cycles){
-//    currentCycle++;
-//
-//    //gen & set random input values
-//    it = inputs.begin();
-//    for (; it != inputs.end(); ++it) {
-//      if(rand()%2){
-//        it->second->set_left(Node1, false);
-//        out << "1";
-//      }
-//      else{
-//        it->second->set_left(Node0, false);
-//        out << "0";
-//      }
-//    }
-//
-//    out << " ";
-//    // for each latch sim cycle
-//    latchIndex = 0;
-//    it = latches.begin();
-//    for (; it != latches.end(); ++it){
-//      latch = it->second;
-//
-//      if(latch->get_left() == Node0)
-//        out << "0";
-//      else
-//        out << "1";
-//
-//      nextState = recursiveSim(latch->get_right(), traversedNodes);
-//      for(int i = 0; i < traversedNodes.size(); i++){
-//        traversedNodes[i]->set_dependence(NOTSET);
-//      }
-//      traversedNodes.clear();
-//
-//      if(latch->get_rpol())
-//        nextState ? nextState = false : nextState = true;
-//
-//      latchValues[latchIndex++] = nextState;
-//    }
-//
-//    // set latch current state value
-//    latchIndex = 0;
-//    it = latches.begin();
-//    for(; it != latches.end(); ++it){
-//      latch = it->second;
-//      if(latchValues[latchIndex++])
-//        latch->set_left(Node1, false);
-//      else
-//        latch->set_left(Node0, false);
-//    }
-//
-//    out << " " << recursiveSim(function, traversedNodes) << endl;
-//    for(int i = 0; i < traversedNodes.size(); i++){
-//      traversedNodes[i]->set_dependence(NOTSET);
-//    }
-//    traversedNodes.clear();
-//  }
-//}
-//
-//void AigDef::sim(AigNode* function, unsigned cycles){
-//  bool nextState;
-//  int currentCycle = 0;
-//  int latchIndex = 0;
-//  AigNode* latch, *nsFunction;
-//  vector<AigNode*> traversedNodes;
-//  NodeMap latches;
-//  NodeMap inputs;
-//
-//  if(!function){
-//    cerr << "[aig.cc state_space_traversal] NULL function node" << endl;
-//    exit(1);
-//  }
-//  else if(function->is_const()){
-//    cout << "[aig.cc state_space_traversal] function is constant" << endl;
-//    return;
-//  }
-//  else if(function->is_input()){
-//    cout << "[aig.cc state_space_traversal] function is input" << endl;
-//    return;
-//  }
-//
-//  //find latch variables
-//  mapLatches(function, latches);
-//  if(latches.size() == 0){
-//    cout << "[aig.cc sim] function is combinational" << endl;
-//    return;
-//  }
-//
-//  //find input variables
-//  mapInputs(function, inputs);
-//
-//  //temporary storage
-//  bool latchValues[(int)latches.size()];
-//
-//  //find input variables
-//  NodeMap::iterator it = latches.begin();
-//  for (; it != latches.end(); ++it) {
-//    latch = it->second;
-//    mapInputs(latch->get_right(), inputs);
-//
-//    if(latch->get_left() == Node0)
-//      nextState = false;
-//    else
-//      nextState = true;
-//
-//    latchValues[latchIndex++] = nextState;
-//  }
-//
-//  for(int i = 0; i < inputs.size(); i++){
-//    cout << "  ";
-//  }
-//  cout << " ";
-//
-//  for(int i = 0; i < latches.size(); ++i){
-//    cout << latchValues[i] << " ";
-//  }
-//  cout << endl;
-//
-//  srand((unsigned)time(0));
-//
-//  while(currentCycle < cycles){
-//    currentCycle++;
-//
-//    //gen & set random input values
-//    it = inputs.begin();
-//    for (; it != inputs.end(); ++it) {
-//      if(rand()%2){
-//        it->second->set_left(Node1, false);
-//        cout << "1 ";
-//      }
-//      else{
-//        it->second->set_left(Node0, false);
-//        cout << "0 ";
-//      }
-//    }
-//
-//    cout << " ";
-//    // for each latch sim cycle
-//    latchIndex = 0;
-//    it = latches.begin();
-//    for (; it != latches.end(); ++it){
-//      latch = it->second;
-//      nextState = recursiveSim(latch->get_right(), traversedNodes);
-//      for(int i = 0; i < traversedNodes.size(); i++){
-//        traversedNodes[i]->set_dependence(NOTSET);
-//      }
-//      traversedNodes.clear();
-//
-//      if(latch->get_rpol())
-//        nextState ? nextState = false : nextState = true;
-//
-//      cout << nextState << " ";
-//      latchValues[latchIndex++] = nextState;
-//    }
-//
-//    // set latch current state value
-//    latchIndex = 0;
-//    it = latches.begin();
-//    for(; it != latches.end(); ++it){
-//      latch = it->second;
-//      if(latchValues[latchIndex++])
-//        latch->set_left(Node1, false);
-//      else
-//        latch->set_left(Node0, false);
-//    }
-//
-//    cout << " " << recursiveSim(function, traversedNodes) << " " << endl;
-//    for(int i = 0; i < traversedNodes.size(); i++){
-//      traversedNodes[i]->set_dependence(NOTSET);
-//    }
-//    traversedNodes.clear();
-//  }
-//}
-
 void AigDef::clear_flags(void){
   AigNode* curr;
 
@@ -538,6 +292,180 @@ void AigDef::clean(void) {
     recursive_erase(danglingNodes[i]);
 }
 
+// append the unnumbered nodes of a cone to idTbl in topological order
+void AigDef::order_cone(AigNode* root){
+  AigNode* node;
+  bool expanded;
+  vector<pair<AigNode*, bool> > stack;
+
+  if(!root)
+    return;
+
+  stack.push_back(make_pair(root, false));
+  while(!stack.empty()){
+    node = stack.back().first;
+    expanded = stack.back().second;
+    stack.pop_back();
+
+    // children done, number the node
+    if(expanded){
+      node->set_dependence(DEPENDENT);
+      node->set_id(idTbl.size());
+      idTbl.push_back(node);
+      continue;
+    }
+
+    if(node->get_dependence() != NOTSET)
+      continue;
+
+    node->set_dependence(NOTDEPENDENT);
+    stack.push_back(make_pair(node, true));
+    if(node->get_right())
+      stack.push_back(make_pair(node->get_right(), false));
+    if(node->get_left())
+      stack.push_back(make_pair(node->get_left(), false));
+  }
+}
+
+// build the compressed sparse row fanout index of the cleaned aig
+void AigDef::buildFanout(vector<AigNode*> &inputs, vector<AigNode*> &latches, vector<AigNode*> &latchLogic, vector<AigNode*> &outputs){
+  unsigned i, id, total;
+  AigNode* node;
+  AigNode* terminals[2] = { Node0, Node1 };
+
+  idTbl.clear();
+
+  // terminals are numbered first
+  for(i = 0; i < 2; i++){
+    terminals[i]->set_id(idTbl.size());
+    terminals[i]->set_dependence(DEPENDENT);
+    idTbl.push_back(terminals[i]);
+  }
+
+  for(i = 0; i < inputs.size(); i++){
+    inputs[i]->set_id(idTbl.size());
+    inputs[i]->set_dependence(DEPENDENT);
+    idTbl.push_back(inputs[i]);
+  }
+
+  for(i = 0; i < latches.size(); i++){
+    latches[i]->set_id(idTbl.size());
+    latches[i]->set_dependence(DEPENDENT);
+    idTbl.push_back(latches[i]);
+  }
+
+  // and nodes in topological order
+  for(i = 0; i < latchLogic.size(); i++)
+    order_cone(latchLogic[i]);
+
+  for(i = 0; i < outputs.size(); i++)
+    order_cone(outputs[i]);
+
+  clear_flags(idTbl);
+
+  outputCount = outputs.size();
+  total = numIds();
+
+  // count fanouts, offset by one for the prefix sum
+  fanoutStart.assign(total + 1, 0);
+  for(i = 0; i < idTbl.size(); i++){
+    node = idTbl[i];
+    if(node->get_left())
+      fanoutStart[node->get_left()->get_id() + 1]++;
+    if(node->get_right())
+      fanoutStart[node->get_right()->get_id() + 1]++;
+  }
+
+  for(i = 0; i < latchLogic.size(); i++)
+    fanoutStart[latchLogic[i]->get_id() + 1]++;
+
+  for(i = 0; i < outputs.size(); i++)
+    fanoutStart[outputs[i]->get_id() + 1]++;
+
+  for(i = 0; i < total; i++)
+    fanoutStart[i + 1] += fanoutStart[i];
+
+  // fill consumers; latch next state edges point at the latch id,
+  // output edges at the output id
+  vector<unsigned> fill(fanoutStart.begin(), fanoutStart.end() - 1);
+  fanoutList.resize(fanoutStart[total]);
+
+  for(i = 0; i < idTbl.size(); i++){
+    node = idTbl[i];
+    if(node->get_left())
+      fanoutList[fill[node->get_left()->get_id()]++] = i;
+    if(node->get_right())
+      fanoutList[fill[node->get_right()->get_id()]++] = i;
+  }
+
+  for(i = 0; i < latchLogic.size(); i++){
+    id = latchLogic[i]->get_id();
+    fanoutList[fill[id]++] = latches[i]->get_id();
+  }
+
+  for(i = 0; i < outputs.size(); i++){
+    id = outputs[i]->get_id();
+    fanoutList[fill[id]++] = idTbl.size() + i;
+  }
+}
+
+// set node levels over the fanout index, returns the maximum level
+unsigned AigDef::levelize(void){
+  unsigned i, level, maxLevel;
+  AigNode* node;
+
+  maxLevel = 0;
+  for(i = 0; i < idTbl.size(); i++){
+    node = idTbl[i];
+    level = 0;
+
+    if(node->get_left() && node->get_left()->get_level() + 1 > level)
+      level = node->get_left()->get_level() + 1;
+    if(node->get_right() && node->get_right()->get_level() + 1 > level)
+      level = node->get_right()->get_level() + 1;
+
+    node->set_level(level);
+    if(level > maxLevel)
+      maxLevel = level;
+  }
+
+  return maxLevel;
+}
+
+unsigned AigDef::numIds(void) const {
+  return idTbl.size() + outputCount;
+}
+
+unsigned AigDef::numNodeIds(void) const {
+  return idTbl.size();
+}
+
+// node of an id, NULL for output ids
+AigNode* AigDef::idNode(unsigned id) const {
+  if(id < idTbl.size())
+    return idTbl[id];
+
+  return 0;
+}
+
+unsigned AigDef::fanoutCount(unsigned id) const {
+  return fanoutStart[id + 1] - fanoutStart[id];
+}
+
+const unsigned* AigDef::fanoutBegin(unsigned id) const {
+  if(fanoutList.empty())
+    return 0;
+
+  return &fanoutList[0] + fanoutStart[id];
+}
+
+const unsigned* AigDef::fanoutEnd(unsigned id) const {
+  if(fanoutList.empty())
+    return 0;
+
+  return &fanoutList[0] + fanoutStart[id + 1];
+}
+
 AigNode* AigDef::One(void) const {
   return Node1;
 }
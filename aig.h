@@ -11,6 +11,13 @@
 
 typedef hash_map<const unsigned, AigNode*, hash<unsigned>, eqNode> NodeMap;
 
+// edge to a node with optional complement, constants are Zero()/!Zero()
+struct AigLit
+{
+  AigNode* node;
+  bool pol;
+};
+
 
 class AigDef {
 
@@ -29,6 +36,10 @@ public:
   AigNode* NewAndNode(AigNode* left, bool lpol, AigNode* right, bool rpol, unsigned index);
   AigNode* NewAndNode(AigNode* left, bool lpol, AigNode* right, bool rpol);
 
+  AigLit NodeLit(AigNode* node) const;
+  AigLit AndLit(AigLit left, AigLit right);
+  AigNode* LitNode(AigLit lit);
+
   void clean(void);
   void recursive_erase(AigNode* node);
   void erase(AigNode* node);
@@ -36,19 +47,33 @@ public:
   unsigned getIndex();
   static unsigned aigerIndex(unsigned lit);
 
-  void sim(AigNode* function, unsigned cycles);
-  void sim(AigNode* function, unsigned cycles, NodeMap &latches, NodeMap &inputs, ostream &out);
-  void sim(AigNode* function, vector<AigNode*> &latches, vector<AigNode*> &inputs, vector<AigNode*> &latchLogic, string inputFile, string outputFile);
   bool recursiveSim(AigNode* function, valMap &terminalValues, vector<AigNode*> &traversedNodes);
 
+  // Fanout index. Ids are dense and topological: constants, inputs,
+  // latches, then ands. Outputs get ids after all nodes.
+  void buildFanout(vector<AigNode*> &inputs, vector<AigNode*> &latches, vector<AigNode*> &latchLogic, vector<AigNode*> &outputs);
+  unsigned numIds(void) const;
+  unsigned numNodeIds(void) const;
+  AigNode* idNode(unsigned id) const;
+  unsigned fanoutCount(unsigned id) const;
+  const unsigned* fanoutBegin(unsigned id) const;
+  const unsigned* fanoutEnd(unsigned id) const;
+  unsigned levelize(void);
+
 private:
   NodeSet NodeTbl; 
   AigNode* Node0;
   AigNode* Node1;
   unsigned indexCount;
 
+  vector<AigNode*> idTbl;
+  unsigned outputCount;
+  vector<unsigned> fanoutStart;
+  vector<unsigned> fanoutList;
+
   void clear_flags(void);
   void clear_flags(vector<AigNode*> &vec);
+  void order_cone(AigNode* root);
 };
 
 #endif
@@ -0,0 +1,278 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "aig.h"
+#include "aiggen.h"
+#include "aigload.h"
+#include "aigwrite.h"
+#include "aigprog.h"
+#include "aigsim.h"
+#include "aigref.h"
+
+#define BENCH_USAGE \
+"\n" \
+"usage: aigbench [-h][-c #cycles][-t seconds][-e engine][-d dir][-k] [design...]\n" \
+"\n" \
+"  -h     print this command line option summary\n" \
+"  -c     # cycles per engine (default is 1,000,000)\n" \
+"  -t     time limit per engine in seconds (default is 2)\n" \
+"  -e     compiled, lanes or recursive, may be repeated (default is all)\n" \
+"  -d     directory of the generated aiger files (default is /tmp)\n" \
+"  -k     keep the generated files\n" \
+"  design random:ands[xseed], mult:bits, adder:bits, counter:bits,\n" \
+"         shift:banksxdepth or lfsr:bits (default is a suite of each)\n" \
+"\n" \
+"  Prints a JSON object per design and engine.  The lanes engine steps 64\n" \
+"  runs at once, its cycles count each of them.  An engine finishes the\n" \
+"  cycle it is in when the time is up.\n" \
+"\n"
+
+// stimulus cycles through this many random rows
+#define BENCH_ROWS 256
+// cycles between reading the clock
+#define BENCH_CHECK 16
+
+static const char* defaultDesigns[] = { "random:100000", "mult:64", "adder:4096", "counter:4096", "shift:32x1024", "lfsr:4096", NULL };
+
+struct BenchRun
+{
+  uint64_t cycles;
+  uint64_t evaluations;
+  double seconds;
+};
+
+static double now(void){
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void run_compiled(const AigProgram &program, const vector<unsigned char> &rows, uint64_t cycles, double limit, BenchRun &run){
+  AigSim sim(program);
+  vector<unsigned char> state(program.numLatches() + 1), out(program.numOutputs() + 1);
+  unsigned n = program.numInputs();
+  double start = now();
+  uint64_t c;
+
+  for(c = 0; c < cycles; c++){
+    if(c % BENCH_CHECK == 0 && now() - start >= limit)
+      break;
+    sim.step(&rows[(c % BENCH_ROWS) * n], &state[0], &out[0]);
+  }
+
+  run.seconds = now() - start;
+  run.cycles = c;
+  run.evaluations = c * (program.numAnds() + program.numCone());
+}
+
+static void run_lanes(const AigProgram &program, const vector<uint64_t> &rows, uint64_t cycles, double limit, BenchRun &run){
+  AigLaneSim sim(program);
+  vector<uint64_t> state(program.numLatches() + 1), out(program.numOutputs() + 1);
+  unsigned n = program.numInputs();
+  double start = now();
+  uint64_t c;
+
+  for(c = 0; c < cycles; c += 64){
+    if(c % (64 * BENCH_CHECK) == 0 && now() - start >= limit)
+      break;
+    sim.step(&rows[(c / 64 % BENCH_ROWS) * n], &state[0], &out[0]);
+  }
+
+  run.seconds = now() - start;
+  run.cycles = c;
+  run.evaluations = c * (program.numAnds() + program.numCone());
+}
+
+static void run_recursive(AigRefSim &sim, unsigned numInputs, unsigned numLatches, unsigned numOutputs, const vector<unsigned char> &rows, uint64_t cycles, double limit, BenchRun &run){
+  vector<unsigned char> state(numLatches + 1), out(numOutputs + 1);
+  double start = now();
+  uint64_t c;
+
+  // a cycle may take long, the clock is read every cycle
+  sim.reset();
+  for(c = 0; c < cycles; c++){
+    if(now() - start >= limit)
+      break;
+    sim.step(&rows[(c % BENCH_ROWS) * numInputs], &state[0], &out[0]);
+  }
+
+  run.seconds = now() - start;
+  run.cycles = c;
+  run.evaluations = sim.evaluations();
+}
+
+// Generates the design into a file, loads and compiles it as sim does and
+// runs each engine on the same random stimulus.  False if the spec is
+// invalid or a file can't be written or read.
+static bool bench(const string &spec, const string &dir, bool keep, const vector<string> &engines, uint64_t cycles, double limit){
+  string fileName, name = spec;
+  double t0, generateTime, loadTime, cleanTime, compileTime;
+  unsigned i, n;
+  uint64_t seed = 88172645463325252ULL;
+  struct stat st;
+  vector<string> observed;
+  vector<unsigned char> rows;
+  vector<uint64_t> laneRows;
+  BenchRun run;
+  AigProgram program;
+
+  for(i = 0; i < name.size(); i++)
+    if(name[i] == ':')
+      name[i] = '-';
+  fileName = dir + "/bench-" + name + ".aig";
+
+  {
+    AigDef mgr;
+    vector<AigNode*> inputs, latches, latchLogic, outputs;
+    AigGen gen(mgr, inputs, latches, latchLogic, outputs);
+
+    t0 = now();
+    if(!gen.generate(spec)){
+      cerr << "Invalid design " << spec << endl;
+      return false;
+    }
+    generateTime = now() - t0;
+
+    ofstream aig(fileName.c_str(), ios::out | ios::binary);
+    if(!aig.is_open()){
+      cerr << "Unable to open file " << fileName << endl;
+      return false;
+    }
+
+    AigWrite writer(mgr, inputs, latches, latchLogic, outputs);
+    bool written = writer.write(aig);
+    aig.close();
+    if(!written || aig.fail()){
+      cerr << "Unable to write file " << fileName << endl;
+      return false;
+    }
+  }
+
+  AigDef mgr;
+  vector<AigNode*> inputs, latches, latchLogic, outputs;
+  AigLoad loader(mgr, inputs, latches, latchLogic, outputs);
+
+  t0 = now();
+  if(!loader.load(fileName.c_str(), observed, false)){
+    cerr << loader.error() << endl;
+    return false;
+  }
+  loadTime = now() - t0;
+
+  t0 = now();
+  mgr.clean();
+  cleanTime = now() - t0;
+
+  t0 = now();
+  program.compile(mgr, inputs, latches, latchLogic, outputs);
+  compileTime = now() - t0;
+
+  if(stat(fileName.c_str(), &st))
+    st.st_size = 0;
+  if(!keep)
+    unlink(fileName.c_str());
+
+  n = program.numInputs();
+  rows.resize(BENCH_ROWS * n + 1);
+  laneRows.resize(BENCH_ROWS * n + 1);
+  for(i = 0; i < BENCH_ROWS * n; i++){
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    rows[i] = seed & 1;
+    laneRows[i] = seed;
+  }
+
+  AigRefSim ref(mgr, inputs, latches, latchLogic, outputs);
+
+  for(i = 0; i < engines.size(); i++){
+    if(engines[i] == "compiled")
+      run_compiled(program, rows, cycles, limit, run);
+    else if(engines[i] == "lanes")
+      run_lanes(program, laneRows, cycles, limit, run);
+    else
+      run_recursive(ref, n, program.numLatches(), program.numOutputs(), rows, cycles, limit, run);
+
+    printf("{\"design\":\"%s\",\"engine\":\"%s\",\"inputs\":%u,\"latches\":%u,\"outputs\":%u,\"ands\":%u,\"levels\":%u,"
+           "\"file_bytes\":%llu,\"generate_s\":%.6f,\"load_s\":%.6f,\"clean_s\":%.6f,\"compile_s\":%.6f,"
+           "\"cycles\":%llu,\"sim_s\":%.6f,\"cycles_per_s\":%.1f,\"evals_per_s\":%.1f}\n",
+           spec.c_str(), engines[i].c_str(), n, program.numLatches(), program.numOutputs(), program.numAnds(), program.numLevels(),
+           (unsigned long long) st.st_size, generateTime, loadTime, cleanTime, compileTime,
+           (unsigned long long) run.cycles, run.seconds, run.seconds > 0 ? run.cycles / run.seconds : 0.0,
+           run.seconds > 0 ? run.evaluations / run.seconds : 0.0);
+    fflush(stdout);
+  }
+
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  bool keep = false;
+  bool ok = true;
+  uint64_t cycles = 1000000;
+  double limit = 2;
+  string dir = "/tmp";
+  vector<string> engines;
+  vector<string> designs;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (!strcmp (argv[i], "-h"))
+    {
+      cerr << BENCH_USAGE << endl;
+      exit (0);
+    }
+    else if(!strcmp(argv[i], "-k"))
+      keep = true;
+    else if((!strcmp(argv[i], "-c") || !strcmp(argv[i], "-t") || !strcmp(argv[i], "-e") || !strcmp(argv[i], "-d")) && i + 1 < argc){
+      if(argv[i][1] == 'c')
+        cycles = strtoull(argv[i + 1], NULL, 10);
+      else if(argv[i][1] == 't')
+        limit = atof(argv[i + 1]);
+      else if(argv[i][1] == 'd')
+        dir = argv[i + 1];
+      else if(!strcmp(argv[i + 1], "compiled") || !strcmp(argv[i + 1], "lanes") || !strcmp(argv[i + 1], "recursive"))
+        engines.push_back(argv[i + 1]);
+      else{
+        cerr << "[aigbench.cc main] unknown engine " << argv[i + 1] << endl;
+        exit (1);
+      }
+      i++;
+    }
+    else if (argv[i][0] == '-'){
+      cerr << "[aigbench.cc main] invalid command line option " << argv[i] << endl;
+      cerr << BENCH_USAGE << endl;
+      exit (1);
+    }
+    else
+      designs.push_back(argv[i]);
+  }
+
+  if(!cycles || limit <= 0){
+    cerr << BENCH_USAGE << endl;
+    exit (1);
+  }
+
+  if(engines.empty()){
+    engines.push_back("compiled");
+    engines.push_back("lanes");
+    engines.push_back("recursive");
+  }
+
+  if(designs.empty())
+    for(int i = 0; defaultDesigns[i]; i++)
+      designs.push_back(defaultDesigns[i]);
+
+  for(unsigned i = 0; i < designs.size(); i++)
+    ok = bench(designs[i], dir, keep, engines, cycles, limit) && ok;
+
+  return ok ? 0 : 1;
+}
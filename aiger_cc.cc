@@ -5,6 +5,22 @@
 #include <cstdarg>
 #include "aiger_cc.h"
 
+extern "C" {
+  #include <stdint.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/types.h>
+  #include <sys/stat.h>
+  #include <sys/mman.h>
+  #include <pthread.h>
+#ifdef AIGER_HAVE_ZLIB
+  #include <zlib.h>
+#endif
+#ifdef AIGER_HAVE_ZSTD
+  #include <zstd.h>
+#endif
+}
+
 #define ENLARGE(p,s) \
   do { \
     size_t old_size = (s); \
@@ -84,11 +100,35 @@ struct aiger_priv
   unsigned num_comments;
   unsigned size_comments;
 
+  /* Takes the ANDs instead of 'ands' while streaming.
+   */
+  aiger_and_sink sink;
+  void *sink_state;
+
+  /* Symbols and comments are not parsed, only located.
+   */
+  size_t symbols_offset;
+
   void *memory_mgr;
 
   char *error;
 };
 
+/* In memory input, e.g. a mapped file.  Streamed input, e.g. a
+ * decompressed file, is a window over the input starting at 'offset' which
+ * 'refill' moves forward, keeping the unread bytes.  It returns zero once
+ * the input is exhausted.
+ */
+struct aiger_buffer
+{
+  const unsigned char *start;
+  const unsigned char *cur;
+  const unsigned char *end;
+  size_t offset;
+  int (*refill) (aiger_buffer *);
+  void *state;
+};
+
 struct aiger_reader
 {
   void *state;
@@ -164,12 +204,62 @@ aiger_init_mem (memory *memory_mgr)
   return pub;
 }
 
+static void
+aiger_delete_symbols (aiger_priv * priv, aiger_symbol * symbols,
+                      unsigned num_symbols, unsigned size_symbols)
+{
+  unsigned i;
+
+  for (i = 0; i < num_symbols; i++)
+    if (symbols[i].name)
+      DELETEN (symbols[i].name, strlen (symbols[i].name) + 1);
+
+  DELETEN (symbols, size_symbols);
+}
+
+void
+aiger_reset (aiger * pub)
+{
+  IMPORT_priv_FROM (pub);
+  unsigned i;
+
+  aiger_delete_symbols (priv, pub->inputs, pub->num_inputs,
+                        priv->size_inputs);
+  aiger_delete_symbols (priv, pub->latches, pub->num_latches,
+                        priv->size_latches);
+  aiger_delete_symbols (priv, pub->outputs, pub->num_outputs,
+                        priv->size_outputs);
+  DELETEN (pub->ands, priv->size_ands);
+
+  for (i = 0; pub->comments[i]; i++)
+    DELETEN (pub->comments[i], strlen (pub->comments[i]) + 1);
+  DELETEN (pub->comments, priv->size_comments);
+
+  DELETEN (priv->types, priv->size_types);
+  DELETEN (priv->coi, priv->size_coi);
+
+  if (priv->error)
+    DELETEN (priv->error, strlen (priv->error) + 1);
+
+  aigtoaig_free ((memory *) priv->memory_mgr, priv, sizeof (*priv));
+}
+
 static int
 aiger_default_get (FILE * file)
 {
   return getc (file);
 }
 
+static int
+aiger_buffer_get (aiger_buffer * buffer)
+{
+  if (buffer->cur == buffer->end
+      && (!buffer->refill || !buffer->refill (buffer)))
+    return EOF;
+
+  return *buffer->cur++;
+}
+
 static const char *
 aiger_error_s (aiger_priv * priv, const char *s, const char *a)
 {
@@ -994,8 +1084,9 @@ aiger_read_header (aiger * pub, aiger_reader * reader)
   } 
   
   //FIT (pub->ands, priv->size_ands, reader->ands); FIT(p,m,n)
+  //binary ANDs are not stored while streaming
   old_size = priv->size_ands; 
-  new_size = reader->ands; 
+  new_size = (priv->sink && reader->mode == aiger_binary_mode) ? 0 : reader->ands; 
   if (old_size < new_size) 
   { 
 	  //REALLOCN (pub->ands,old_size,new_size);  REALLOCN(p,m,n)
@@ -1135,6 +1226,354 @@ aiger_read_ascii (aiger * pub, aiger_reader * reader)
   return 0;
 }
 
+/*------------------------------------------------------------------------*/
+/* Parallel parsing of the ASCII AND section of an in memory file.  The
+ * section is cut into chunks at new line boundaries.  Each thread first
+ * counts the lines of its chunk, then parses its lines into the slots of
+ * 'ands' given by the line prefix sums, and finally the definitions are
+ * checked and registered in parallel.  Format errors are left to the
+ * serial reader, which is rerun to produce the usual message.
+ */
+#define AIGER_PARALLEL_MIN_ANDS (1 << 16)
+#define AIGER_MAX_THREADS 64
+
+struct aiger_ascii_chunk
+{
+  aiger *pub;
+  const unsigned char *begin;
+  const unsigned char *end;
+  const unsigned char *stop;	/* after the last parsed line */
+  unsigned first;		/* index of the first AND of the chunk */
+  unsigned lines;		/* lines counted, then ANDs to parse */
+  int failed;			/* format error */
+  unsigned error_idx;		/* smallest AND with a definition error */
+  const char *error_msg;
+};
+
+static void *
+aiger_ascii_count_lines (void *arg)
+{
+  aiger_ascii_chunk *chunk = (aiger_ascii_chunk *) arg;
+  const unsigned char *p;
+
+  chunk->lines = 0;
+  p = chunk->begin;
+  while (p < chunk->end
+         && (p = (const unsigned char *) memchr (p, '\n', chunk->end - p)))
+    {
+      chunk->lines++;
+      p++;
+    }
+
+  return 0;
+}
+
+static const unsigned char *
+aiger_ascii_parse_literal (const unsigned char *p, unsigned *res_ptr,
+                           char followed_by)
+{
+  unsigned res;
+
+  if (!isdigit (*p))
+    return 0;
+
+  res = 0;
+  while (isdigit (*p))
+    res = 10 * res + (*p++ - '0');
+
+  if (*p != followed_by)
+    return 0;
+
+  *res_ptr = res;
+  return p + 1;
+}
+
+static void *
+aiger_ascii_parse_chunk (void *arg)
+{
+  aiger_ascii_chunk *chunk = (aiger_ascii_chunk *) arg;
+  aiger *pub = chunk->pub;
+  const unsigned char *p;
+  unsigned i, lhs, rhs0, rhs1;
+  aiger_and *andNode;
+
+  p = chunk->begin;
+  andNode = pub->ands + chunk->first;
+
+  for (i = 0; i < chunk->lines; i++)
+    {
+      if (!(p = aiger_ascii_parse_literal (p, &lhs, ' ')) ||
+          !(p = aiger_ascii_parse_literal (p, &rhs0, ' ')) ||
+          !(p = aiger_ascii_parse_literal (p, &rhs1, '\n')))
+        {
+          chunk->failed = 1;
+          return 0;
+        }
+
+      if (!lhs || aiger_sign (lhs)
+          || aiger_lit2var (lhs) > pub->maxvar
+          || aiger_lit2var (rhs0) > pub->maxvar
+          || aiger_lit2var (rhs1) > pub->maxvar)
+        {
+          chunk->failed = 1;
+          return 0;
+        }
+
+      andNode->lhs = lhs;
+      andNode->rhs0 = rhs0;
+      andNode->rhs1 = rhs1;
+      andNode++;
+    }
+
+  chunk->stop = p;
+  return 0;
+}
+
+static void
+aiger_ascii_chunk_error (aiger_ascii_chunk * chunk, unsigned idx,
+                         const char *msg)
+{
+  if (idx < chunk->error_idx)
+    {
+      chunk->error_idx = idx;
+      chunk->error_msg = msg;
+    }
+}
+
+/* Claim each 'lhs' with the smallest index of an AND defining it.  The
+ * 'idx' of unclaimed variables is still zero, claims store index plus one.
+ */
+static void *
+aiger_ascii_claim_chunk (void *arg)
+{
+  aiger_ascii_chunk *chunk = (aiger_ascii_chunk *) arg;
+  IMPORT_priv_FROM (chunk->pub);
+  unsigned i, idx, old, prev;
+  aiger_type *type;
+
+  for (i = 0; i < chunk->lines; i++)
+    {
+      idx = chunk->first + i;
+      type = priv->types + aiger_lit2var (priv->pub.ands[idx].lhs);
+
+      if (type->input)
+        {
+          aiger_ascii_chunk_error (chunk, idx, "already defined as input");
+          continue;
+        }
+
+      if (type->latch)
+        {
+          aiger_ascii_chunk_error (chunk, idx, "already defined as latch");
+          continue;
+        }
+
+      old = type->idx;
+      while (old == 0 || old > idx + 1)
+        {
+          prev = __sync_val_compare_and_swap (&type->idx, old, idx + 1);
+          if (prev == old)
+            break;
+          old = prev;
+        }
+    }
+
+  return 0;
+}
+
+static void *
+aiger_ascii_check_chunk (void *arg)
+{
+  aiger_ascii_chunk *chunk = (aiger_ascii_chunk *) arg;
+  IMPORT_priv_FROM (chunk->pub);
+  unsigned i, idx;
+  aiger_type *type;
+
+  for (i = 0; i < chunk->lines; i++)
+    {
+      idx = chunk->first + i;
+      type = priv->types + aiger_lit2var (priv->pub.ands[idx].lhs);
+
+      if (!type->input && !type->latch && type->idx != idx + 1)
+        aiger_ascii_chunk_error (chunk, idx, "already defined as AND");
+    }
+
+  return 0;
+}
+
+static void *
+aiger_ascii_define_chunk (void *arg)
+{
+  aiger_ascii_chunk *chunk = (aiger_ascii_chunk *) arg;
+  IMPORT_priv_FROM (chunk->pub);
+  unsigned i, idx;
+  aiger_type *type;
+
+  for (i = 0; i < chunk->lines; i++)
+    {
+      idx = chunk->first + i;
+      type = priv->types + aiger_lit2var (priv->pub.ands[idx].lhs);
+      type->andNode = 1;
+      type->idx = idx;
+    }
+
+  return 0;
+}
+
+/* Run 'fun' on every chunk, the last one on the calling thread.
+ */
+static void
+aiger_run_chunks (aiger_ascii_chunk * chunks, unsigned num_chunks,
+                  void *(*fun) (void *))
+{
+  pthread_t threads[AIGER_MAX_THREADS];
+  int started[AIGER_MAX_THREADS];
+  unsigned i;
+
+  for (i = 0; i + 1 < num_chunks; i++)
+    started[i] = !pthread_create (threads + i, 0, fun, chunks + i);
+
+  fun (chunks + num_chunks - 1);
+
+  for (i = 0; i + 1 < num_chunks; i++)
+    {
+      if (started[i])
+        pthread_join (threads[i], 0);
+      else
+        fun (chunks + i);
+    }
+}
+
+static unsigned
+aiger_num_threads (void)
+{
+  long res = sysconf (_SC_NPROCESSORS_ONLN);
+
+  if (res < 1)
+    return 1;
+
+  if (res > AIGER_MAX_THREADS)
+    return AIGER_MAX_THREADS;
+
+  return res;
+}
+
+static const char *
+aiger_read_ascii_buffer (aiger * pub, aiger_reader * reader,
+                         aiger_buffer * buffer)
+{
+  IMPORT_priv_FROM (pub);
+  aiger_ascii_chunk chunks[AIGER_MAX_THREADS];
+  const unsigned char *start, *end, *p;
+  unsigned i, num_chunks, lines, error_idx;
+  const char *error_msg;
+  size_t size;
+
+  num_chunks = aiger_num_threads ();
+  if (reader->ands < AIGER_PARALLEL_MIN_ANDS || num_chunks < 2
+      || reader->ch == EOF)
+    return aiger_read_ascii (pub, reader);
+
+  /* The reader already holds the first character of the section.
+   */
+  start = buffer->cur - 1;
+  end = buffer->end;
+  size = end - start;
+
+  memset (chunks, 0, sizeof (chunks));
+  p = start;
+  for (i = 0; i < num_chunks; i++)
+    {
+      chunks[i].pub = pub;
+      chunks[i].begin = p;
+      chunks[i].error_idx = ~0u;
+
+      if (i + 1 == num_chunks)
+        p = end;
+      else
+        {
+          p = start + size / num_chunks * (i + 1);
+          if (p < chunks[i].begin)
+            p = chunks[i].begin;
+          p = (const unsigned char *) memchr (p, '\n', end - p);
+          p = p ? p + 1 : end;
+        }
+
+      chunks[i].end = p;
+    }
+
+  aiger_run_chunks (chunks, num_chunks, aiger_ascii_count_lines);
+
+  /* Line prefix sums, lines after the AND section are not parsed.
+   */
+  lines = 0;
+  for (i = 0; i < num_chunks; i++)
+    {
+      chunks[i].first = lines;
+      lines += chunks[i].lines;
+
+      if (chunks[i].first >= reader->ands)
+        chunks[i].lines = 0;
+      else if (lines > reader->ands)
+        chunks[i].lines = reader->ands - chunks[i].first;
+    }
+
+  if (lines < reader->ands)
+    return aiger_read_ascii (pub, reader);
+
+  aiger_run_chunks (chunks, num_chunks, aiger_ascii_parse_chunk);
+
+  for (i = 0; i < num_chunks; i++)
+    if (chunks[i].failed)
+      return aiger_read_ascii (pub, reader);
+
+  aiger_run_chunks (chunks, num_chunks, aiger_ascii_claim_chunk);
+  aiger_run_chunks (chunks, num_chunks, aiger_ascii_check_chunk);
+
+  error_idx = ~0u;
+  error_msg = 0;
+  for (i = 0; i < num_chunks; i++)
+    if (chunks[i].error_idx < error_idx)
+      {
+        error_idx = chunks[i].error_idx;
+        error_msg = chunks[i].error_msg;
+      }
+
+  if (error_msg)
+    {
+      if (!strcmp (error_msg, "already defined as input"))
+        return aiger_error_uu (priv,
+                               "line %u: literal %u already defined as input",
+                               reader->lineno + error_idx,
+                               pub->ands[error_idx].lhs);
+
+      if (!strcmp (error_msg, "already defined as latch"))
+        return aiger_error_uu (priv,
+                               "line %u: literal %u already defined as latch",
+                               reader->lineno + error_idx,
+                               pub->ands[error_idx].lhs);
+
+      return aiger_error_uu (priv,
+                             "line %u: literal %u already defined as AND",
+                             reader->lineno + error_idx,
+                             pub->ands[error_idx].lhs);
+    }
+
+  aiger_run_chunks (chunks, num_chunks, aiger_ascii_define_chunk);
+  pub->num_ands = reader->ands;
+
+  /* Continue the character reader after the section.
+   */
+  for (i = 0; i < num_chunks; i++)
+    if (chunks[i].lines && chunks[i].first + chunks[i].lines == reader->ands)
+      buffer->cur = chunks[i].stop;
+
+  reader->lineno += reader->ands;
+  reader->ch = aiger_buffer_get (buffer);
+
+  return 0;
+}
+
 static const char *
 aiger_read_delta (aiger_priv * priv, aiger_reader * reader,
 		  unsigned *res_ptr)
@@ -1157,7 +1596,7 @@ aiger_read_delta (aiger_priv * priv, aiger_reader * reader,
     {
       assert (sizeof (unsigned) == 4);
 
-      if (i == 5)
+      if (i == 4)
       INVALID_CODE:
 	return aiger_error_u (priv, "character %u: invalid code", charno);
 
@@ -1169,7 +1608,7 @@ aiger_read_delta (aiger_priv * priv, aiger_reader * reader,
       ch = reader->ch;
     }
 
-  if (i == 5 && ch >= 8)
+  if (i == 4 && ch >= 16)
     goto INVALID_CODE;
 
   res |= ch << (7 * i);
@@ -1219,34 +1658,274 @@ aiger_read_binary (aiger * pub, aiger_reader * reader)
   return 0;
 }
 
-const char *
-aiger_read_generic (aiger * pub, void *state, aiger_get get)
+#define AIGER_HIGH_BITS 0x8080808080808080ULL
+
+#define AIGER_DELTA_EOF 1
+#define AIGER_DELTA_INVALID 2
+
+/* Decode one delta starting at '*p_ptr' and advance the pointer.  Returns
+ * zero or one of the error codes above.
+ */
+static int
+aiger_decode_delta (const unsigned char **p_ptr, const unsigned char *end,
+                    unsigned *res_ptr)
+{
+  const unsigned char *p = *p_ptr;
+  unsigned res, i, ch;
+
+  if (p == end)
+    return AIGER_DELTA_EOF;
+
+  i = 0;
+  res = 0;
+  ch = *p;
+
+  while ((ch & 0x80))
+    {
+      if (i == 4)
+        return AIGER_DELTA_INVALID;
+
+      res |= (ch & 0x7f) << (7 * i++);
+      if (++p == end)
+        return AIGER_DELTA_EOF;
+
+      ch = *p;
+    }
+
+  if (i == 4 && ch >= 16)
+    return AIGER_DELTA_INVALID;
+
+  res |= ch << (7 * i);
+  *res_ptr = res;
+  *p_ptr = p + 1;
+
+  return 0;
+}
+
+#define AIGER_SINK_BATCH 4096
+
+/* Binary AND section straight out of a buffer.  The header already sized
+ * 'ands' and 'types', so ANDs are written in place instead of going
+ * through 'aiger_add_and'.  Runs of single byte deltas, by far the common
+ * case, are detected eight bytes (four ANDs) at a time.  An AND cut by the
+ * end of a streamed buffer is decoded again after a refill.  With a sink
+ * the ANDs are collected in batches and never stored.
+ */
+static const char *
+aiger_read_binary_buffer (aiger * pub, aiger_reader * reader,
+                          aiger_buffer * buffer)
 {
   IMPORT_priv_FROM (pub);
-  aiger_reader reader;
-  const char *error;
+  const unsigned char *p, *start, *end, *delta_start, *and_start;
+  unsigned i, k, lhs, rhs0, rhs1, delta;
+  aiger_and batch[AIGER_SINK_BATCH];
+  aiger_and *andNode, *limit;
+  aiger_type *type;
+  uint64_t word;
+  int code, refilled;
 
-  assert (!aiger_error (pub));
+  start = buffer->start;
+  end = buffer->end;
 
-  memset (&reader, 0, sizeof (reader));
+  /* The reader already holds the first byte of the section in 'ch'.
+   */
+  p = (reader->ch == EOF) ? end : buffer->cur - 1;
 
-  reader.lineno = 1;
-  reader.state = state;
-  reader.get = get;
-  reader.ch = ' ';
+  lhs = aiger_max_input_or_latch (pub);
+
+  if (priv->sink)
+    {
+      andNode = batch;
+      limit = batch + AIGER_SINK_BATCH;
+    }
+  else
+    {
+      andNode = pub->ands + pub->num_ands;
+      limit = 0;
+    }
+
+  i = 0;
+  while (i < reader->ands)
+    {
+      while (i + 4 <= reader->ands && end - p >= 8)
+        {
+          memcpy (&word, p, sizeof (word));
+          if (word & AIGER_HIGH_BITS)
+            break;
+
+          if (limit && andNode + 4 > limit)
+            {
+              priv->sink (priv->sink_state, batch, andNode - batch);
+              andNode = batch;
+            }
+
+          for (k = 0; k < 4; k++)
+            {
+              lhs += 2;
+              if (p[0] > lhs || p[1] > lhs - p[0])
+                goto INVALID_DELTA_AT_P;
+
+              andNode->lhs = lhs;
+              andNode->rhs0 = lhs - p[0];
+              andNode->rhs1 = andNode->rhs0 - p[1];
+              andNode++;
+              p += 2;
+            }
+
+          i += 4;
+        }
+
+      if (i == reader->ands)
+        break;
+
+      lhs += 2;
+
+      and_start = delta_start = p;
+      code = aiger_decode_delta (&p, end, &delta);
+      if (!code)
+        {
+          if (delta > lhs)
+            goto INVALID_DELTA;
+
+          rhs0 = lhs - delta;
+
+          delta_start = p;
+          code = aiger_decode_delta (&p, end, &delta);
+        }
+
+      if (code == AIGER_DELTA_EOF && buffer->refill)
+        {
+          buffer->cur = and_start;
+          refilled = buffer->refill (buffer);
+          start = buffer->start;
+          end = buffer->end;
+
+          if (refilled)
+            {
+              p = buffer->cur;
+              lhs -= 2;
+              continue;
+            }
+        }
+
+      if (code)
+        goto DELTA_ERROR;
+
+      if (delta > rhs0)
+        goto INVALID_DELTA;
+
+      rhs1 = rhs0 - delta;
+
+      if (andNode == limit)
+        {
+          priv->sink (priv->sink_state, batch, andNode - batch);
+          andNode = batch;
+        }
+
+      andNode->lhs = lhs;
+      andNode->rhs0 = rhs0;
+      andNode->rhs1 = rhs1;
+      andNode++;
+      i++;
+    }
+
+  buffer->cur = p;
+
+  /* The left hand sides of binary ANDs are implied, so nothing needs to
+   * be recorded for them while streaming.
+   */
+  if (priv->sink)
+    {
+      if (andNode > batch)
+        priv->sink (priv->sink_state, batch, andNode - batch);
+
+      return 0;
+    }
+
+  /* Types are only set once all ANDs are known to be valid.
+   */
+  for (i = 0; i < reader->ands; i++)
+    {
+      type = priv->types + aiger_lit2var (pub->ands[i].lhs);
+      type->andNode = 1;
+      type->idx = i;
+    }
+
+  pub->num_ands = reader->ands;
+
+  return 0;
+
+INVALID_DELTA_AT_P:
+  if (p[0] > lhs)
+    delta_start = p;
+  else
+    delta_start = p + 1;
+
+INVALID_DELTA:
+  return aiger_error_u (priv, "character %u: invalid delta",
+                        (unsigned) (buffer->offset + (delta_start - start)) + 1);
+
+DELTA_ERROR:
+  if (code == AIGER_DELTA_EOF)
+    return aiger_error_u (priv, "character %u: unexpected end of file",
+                          (unsigned) (buffer->offset + (end - start)));
+
+  return aiger_error_u (priv, "character %u: invalid code",
+                        (unsigned) (buffer->offset + (delta_start - start)) + 1);
+}
+
+/* Shared by the stream and the buffer readers.  With a non zero 'buffer'
+ * the binary AND section is decoded directly from memory.
+ */
+static const char *
+aiger_read_with_reader (aiger * pub, aiger_reader * reader,
+                        aiger_buffer * buffer)
+{
+  IMPORT_priv_FROM (pub);
+  const char *error;
 
-  error = aiger_read_header (pub, &reader);
+  error = aiger_read_header (pub, reader);
   if (error)
     return error;
 
-  if (reader.mode == aiger_ascii_mode)
-    error = aiger_read_ascii (pub, &reader);
+  if (reader->mode == aiger_ascii_mode && buffer)
+    error = aiger_read_ascii_buffer (pub, reader, buffer);
+  else if (reader->mode == aiger_ascii_mode)
+    error = aiger_read_ascii (pub, reader);
+  else if (buffer)
+    error = aiger_read_binary_buffer (pub, reader, buffer);
   else
-    error = aiger_read_binary (pub, &reader);
+    error = aiger_read_binary (pub, reader);
 
   if (error)
     return error;
 
+  /* The binary buffer reader leaves the next byte unread, the others hold
+   * it in 'ch'.
+   */
+  if (buffer && reader->mode != aiger_ascii_mode)
+    priv->symbols_offset = buffer->offset + (buffer->cur - buffer->start);
+  else if (buffer)
+    priv->symbols_offset = buffer->offset + (buffer->cur - buffer->start)
+                           - (reader->ch != EOF);
+  else
+    priv->symbols_offset = reader->charno - (reader->ch != EOF);
+
+  /* ANDs the reader had to store are handed over at once.  Checking them
+   * is left to the sink.
+   */
+  if (priv->sink)
+    {
+      if (pub->num_ands)
+        priv->sink (priv->sink_state, pub->ands, pub->num_ands);
+
+      DELETEN (pub->ands, priv->size_ands);
+      priv->size_ands = 0;
+      pub->num_ands = 0;
+
+      return 0;
+    }
+
   /*error = aiger_read_symbols (pub, &reader);
   if (!error)
     error = aiger_read_comments (pub, &reader);
@@ -1259,6 +1938,51 @@ aiger_read_generic (aiger * pub, void *state, aiger_get get)
   return aiger_check (pub);
 }
 
+const char *
+aiger_read_generic (aiger * pub, void *state, aiger_get get)
+{
+  aiger_reader reader;
+
+  assert (!aiger_error (pub));
+
+  memset (&reader, 0, sizeof (reader));
+
+  reader.lineno = 1;
+  reader.state = state;
+  reader.get = get;
+  reader.ch = ' ';
+
+  return aiger_read_with_reader (pub, &reader, 0);
+}
+
+const char *
+aiger_read_from_memory (aiger * pub, const char *data, size_t size)
+{
+  aiger_reader reader;
+  aiger_buffer buffer;
+
+  assert (!aiger_error (pub));
+
+  memset (&buffer, 0, sizeof (buffer));
+  buffer.start = buffer.cur = (const unsigned char *) data;
+  buffer.end = buffer.start + size;
+
+  memset (&reader, 0, sizeof (reader));
+
+  reader.lineno = 1;
+  reader.state = &buffer;
+  reader.get = (aiger_get) aiger_buffer_get;
+  reader.ch = ' ';
+
+  return aiger_read_with_reader (pub, &reader, &buffer);
+}
+
+const char *
+aiger_read_from_string (aiger * pub, const char *str)
+{
+  return aiger_read_from_memory (pub, str, strlen (str));
+}
+
 const char *
 aiger_read_from_file (aiger * pub, FILE * file)
 {
@@ -1266,36 +1990,496 @@ aiger_read_from_file (aiger * pub, FILE * file)
   return aiger_read_generic (pub, file, (aiger_get) aiger_default_get);
 }
 
+static const char aiger_not_mapped[] = "not mapped";
+
+/* Returns 'aiger_not_mapped' if the file can not be mapped, e.g. because
+ * it is not a regular file, and the result of the parse otherwise.
+ */
+static const char *
+aiger_map_and_read (aiger * pub, const char *file_name)
+{
+  struct stat st;
+  const char *res;
+  void *data;
+  int fd;
+
+  fd = open (file_name, O_RDONLY);
+  if (fd < 0)
+    return aiger_not_mapped;
+
+  if (fstat (fd, &st) || !S_ISREG (st.st_mode) || st.st_size <= 0)
+  {
+    close (fd);
+    return aiger_not_mapped;
+  }
+
+  data = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (data == MAP_FAILED)
+    return aiger_not_mapped;
+
+  posix_madvise (data, st.st_size, POSIX_MADV_SEQUENTIAL);
+  res = aiger_read_from_memory (pub, (const char *) data, st.st_size);
+  munmap (data, st.st_size);
+
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+/* Compressed files are decompressed in process, block by block, into the
+ * window of a streamed buffer.
+ */
+#define AIGER_BLOCK_SIZE (1 << 20)
+
+#define AIGER_GZIP 0
+#define AIGER_ZSTD 1
+
+struct aiger_decompressor
+{
+  FILE *file;
+  int format;
+  int done;
+  const char *error;		/* format string taking the file name */
+  unsigned char *in;
+  unsigned char *out;
+#ifdef AIGER_HAVE_ZLIB
+  z_stream gz;
+  int gz_end;			/* at the end of a gzip member */
+#endif
+#ifdef AIGER_HAVE_ZSTD
+  ZSTD_DStream *zs;
+  ZSTD_inBuffer zs_in;
+  size_t zs_hint;		/* non zero inside a frame */
+#endif
+};
+
+/* Reads more compressed input.  Returns zero at the end of the file.
+ */
+static size_t
+aiger_decompressor_read (aiger_decompressor * d)
+{
+  size_t res;
+
+  res = fread (d->in, 1, AIGER_BLOCK_SIZE, d->file);
+  if (!res && ferror (d->file))
+    d->error = "read error in '%s'";
+
+  return res;
+}
+
+#ifdef AIGER_HAVE_ZLIB
+static size_t
+aiger_gunzip (aiger_decompressor * d, unsigned char *out, size_t size)
+{
+  z_stream *gz = &d->gz;
+  int ret;
+
+  gz->next_out = out;
+  gz->avail_out = size;
+
+  while (gz->avail_out && !d->done)
+    {
+      if (!gz->avail_in)
+        {
+          gz->next_in = d->in;
+          gz->avail_in = aiger_decompressor_read (d);
+          if (!gz->avail_in)
+            {
+              if (!d->gz_end && !d->error)
+                d->error = "truncated compressed file '%s'";
+              d->done = 1;
+              break;
+            }
+        }
+
+      /* Concatenated members, as written by 'cat a.gz b.gz'.
+       */
+      if (d->gz_end)
+        {
+          inflateReset (gz);
+          d->gz_end = 0;
+        }
+
+      ret = inflate (gz, Z_NO_FLUSH);
+      if (ret == Z_STREAM_END)
+        d->gz_end = 1;
+      else if (ret != Z_OK && ret != Z_BUF_ERROR)
+        {
+          d->error = "corrupt compressed file '%s'";
+          d->done = 1;
+        }
+    }
+
+  return size - gz->avail_out;
+}
+#endif
+
+#ifdef AIGER_HAVE_ZSTD
+static size_t
+aiger_unzstd (aiger_decompressor * d, unsigned char *out, size_t size)
+{
+  ZSTD_outBuffer zs_out;
+
+  zs_out.dst = out;
+  zs_out.size = size;
+  zs_out.pos = 0;
+
+  while (zs_out.pos < size && !d->done)
+    {
+      if (d->zs_in.pos == d->zs_in.size)
+        {
+          d->zs_in.src = d->in;
+          d->zs_in.size = aiger_decompressor_read (d);
+          d->zs_in.pos = 0;
+          if (!d->zs_in.size)
+            {
+              if (d->zs_hint && !d->error)
+                d->error = "truncated compressed file '%s'";
+              d->done = 1;
+              break;
+            }
+        }
+
+      d->zs_hint = ZSTD_decompressStream (d->zs, &zs_out, &d->zs_in);
+      if (ZSTD_isError (d->zs_hint))
+        {
+          d->error = "corrupt compressed file '%s'";
+          d->done = 1;
+        }
+    }
+
+  return zs_out.pos;
+}
+#endif
+
+static int
+aiger_decompressor_refill (aiger_buffer * buffer)
+{
+  aiger_decompressor *d = (aiger_decompressor *) buffer->state;
+  size_t kept, res;
+
+  kept = buffer->end - buffer->cur;
+  buffer->offset += buffer->cur - buffer->start;
+  memmove (d->out, buffer->cur, kept);
+
+  res = 0;
+#ifdef AIGER_HAVE_ZLIB
+  if (d->format == AIGER_GZIP)
+    res = aiger_gunzip (d, d->out + kept, AIGER_BLOCK_SIZE - kept);
+#endif
+#ifdef AIGER_HAVE_ZSTD
+  if (d->format == AIGER_ZSTD)
+    res = aiger_unzstd (d, d->out + kept, AIGER_BLOCK_SIZE - kept);
+#endif
+
+  buffer->start = buffer->cur = d->out;
+  buffer->end = d->out + kept + res;
+
+  return res > 0;
+}
+
+static int
+aiger_decompressor_init (aiger_decompressor * d, FILE * file, int format)
+{
+  memset (d, 0, sizeof (*d));
+  d->file = file;
+  d->format = format;
+
+#ifdef AIGER_HAVE_ZLIB
+  /* Accept gzip and zlib headers.
+   */
+  if (format == AIGER_GZIP && inflateInit2 (&d->gz, 15 + 32) != Z_OK)
+    return 0;
+#endif
+#ifdef AIGER_HAVE_ZSTD
+  if (format == AIGER_ZSTD
+      && (!(d->zs = ZSTD_createDStream ())
+          || ZSTD_isError (ZSTD_initDStream (d->zs))))
+    return 0;
+#endif
+
+  d->in = (unsigned char *) malloc (AIGER_BLOCK_SIZE);
+  d->out = (unsigned char *) malloc (AIGER_BLOCK_SIZE);
+
+  return d->in && d->out;
+}
+
+static void
+aiger_decompressor_release (aiger_decompressor * d)
+{
+#ifdef AIGER_HAVE_ZLIB
+  if (d->format == AIGER_GZIP)
+    inflateEnd (&d->gz);
+#endif
+#ifdef AIGER_HAVE_ZSTD
+  if (d->format == AIGER_ZSTD)
+    ZSTD_freeDStream (d->zs);
+#endif
+
+  free (d->in);
+  free (d->out);
+}
+
+static const char *
+aiger_decompress_and_read (aiger * pub, const char *file_name, int format)
+{
+  IMPORT_priv_FROM (pub);
+  aiger_decompressor d;
+  aiger_reader reader;
+  aiger_buffer buffer;
+  const char *res;
+  FILE *file;
+
+  file = fopen (file_name, "r");
+  if (!file)
+    return aiger_error_s (priv, "can not read '%s'", file_name);
+
+  if (!aiger_decompressor_init (&d, file, format))
+    {
+      aiger_decompressor_release (&d);
+      fclose (file);
+      return aiger_error_s (priv, "can not decompress '%s'", file_name);
+    }
+
+  memset (&buffer, 0, sizeof (buffer));
+  buffer.start = buffer.cur = buffer.end = d.out;
+  buffer.refill = aiger_decompressor_refill;
+  buffer.state = &d;
+
+  memset (&reader, 0, sizeof (reader));
+
+  reader.lineno = 1;
+  reader.state = &buffer;
+  reader.get = (aiger_get) aiger_buffer_get;
+  reader.ch = ' ';
+
+  res = aiger_read_with_reader (pub, &reader, &buffer);
+
+  /* A parse error caused by a damaged file is reported as such.
+   */
+  if (d.error)
+    {
+      if (res)
+        DELETEN (priv->error, strlen (priv->error) + 1);
+
+      res = aiger_error_s (priv, d.error, file_name);
+    }
+
+  aiger_decompressor_release (&d);
+  fclose (file);
+
+  return res;
+}
+
 const char *
 aiger_open_and_read_from_file (aiger * pub, const char *file_name)
 {
   IMPORT_priv_FROM (pub);
-  char *cmd, size_cmd;
   const char *res;
-  int pclose_file;
   FILE *file;
 
   assert (!aiger_error (pub));
 
   if (aiger_has_suffix (file_name, ".gz"))
   {
-    // not used
+#ifdef AIGER_HAVE_ZLIB
+    return aiger_decompress_and_read (pub, file_name, AIGER_GZIP);
+#else
+    return aiger_error_s (priv, "no gzip support to read '%s'", file_name);
+#endif
   }
-  else
+
+  if (aiger_has_suffix (file_name, ".zst"))
   {
-    file = fopen (file_name, "r");
-    pclose_file = 0;
+#ifdef AIGER_HAVE_ZSTD
+    return aiger_decompress_and_read (pub, file_name, AIGER_ZSTD);
+#else
+    return aiger_error_s (priv, "no zstd support to read '%s'", file_name);
+#endif
   }
 
+  /* Regular files are mapped and parsed in place.
+   */
+  res = aiger_map_and_read (pub, file_name);
+  if (res != aiger_not_mapped)
+    return res;
+
+  file = fopen (file_name, "r");
   if (!file)
     return aiger_error_s (priv, "can not read '%s'", file_name);
 
   res = aiger_read_from_file (pub, file);
+  fclose (file);
 
-  if (pclose_file)
-    pclose (file);
-  else
-    fclose (file);
+  return res;
+}
+
+size_t
+aiger_symbols_offset (aiger * pub)
+{
+  IMPORT_priv_FROM (pub);
+  return priv->symbols_offset;
+}
+
+/* Decompress and drop everything before 'offset'.
+ */
+static char *
+aiger_decompress_tail (const char *file_name, int format, size_t offset,
+                       size_t *size_ptr)
+{
+  aiger_decompressor d;
+  aiger_buffer buffer;
+  size_t size, capacity, skip, n;
+  char *res, *tmp;
+  FILE *file;
+
+  file = fopen (file_name, "r");
+  if (!file)
+    return 0;
+
+  size = 0;
+  capacity = 1;
+  res = (char *) malloc (capacity);
+
+  if (!aiger_decompressor_init (&d, file, format))
+    {
+      free (res);
+      res = 0;
+    }
+
+  memset (&buffer, 0, sizeof (buffer));
+  buffer.start = buffer.cur = buffer.end = d.out;
+  buffer.state = &d;
+
+  while (res && aiger_decompressor_refill (&buffer))
+    {
+      skip = 0;
+      if (buffer.offset < offset)
+        skip = offset - buffer.offset;
+      if (skip > (size_t) (buffer.end - buffer.start))
+        skip = buffer.end - buffer.start;
+
+      n = (buffer.end - buffer.start) - skip;
+      if (size + n + 1 > capacity)
+        {
+          capacity = 2 * (size + n + 1);
+          tmp = (char *) realloc (res, capacity);
+          if (!tmp)
+            free (res);
+          res = tmp;
+          if (!res)
+            break;
+        }
+
+      memcpy (res + size, buffer.start + skip, n);
+      size += n;
+      buffer.cur = buffer.end;
+    }
+
+  if (d.error)
+    {
+      free (res);
+      res = 0;
+    }
+
+  aiger_decompressor_release (&d);
+  fclose (file);
+
+  if (res)
+    *size_ptr = size;
+
+  return res;
+}
+
+char *
+aiger_read_tail (const char *file_name, size_t offset, size_t *size_ptr)
+{
+  struct stat st;
+  size_t size, n;
+  ssize_t got;
+  char *res;
+  int fd;
+
+#ifdef AIGER_HAVE_ZLIB
+  if (aiger_has_suffix (file_name, ".gz"))
+    return aiger_decompress_tail (file_name, AIGER_GZIP, offset, size_ptr);
+#endif
+#ifdef AIGER_HAVE_ZSTD
+  if (aiger_has_suffix (file_name, ".zst"))
+    return aiger_decompress_tail (file_name, AIGER_ZSTD, offset, size_ptr);
+#endif
+  if (aiger_has_suffix (file_name, ".gz")
+      || aiger_has_suffix (file_name, ".zst"))
+    return 0;
+
+  fd = open (file_name, O_RDONLY);
+  if (fd < 0)
+    return 0;
+
+  if (fstat (fd, &st) || !S_ISREG (st.st_mode)
+      || (size_t) st.st_size < offset)
+    {
+      close (fd);
+      return 0;
+    }
+
+  size = st.st_size - offset;
+  res = (char *) malloc (size + 1);
+
+  for (n = 0; res && n < size; n += got)
+    {
+      got = pread (fd, res + n, size - n, offset + n);
+      if (got <= 0)
+        {
+          free (res);
+          res = 0;
+        }
+    }
+
+  close (fd);
+
+  if (res)
+    *size_ptr = size;
+
+  return res;
+}
+
+const char *
+aiger_open_and_stream_from_file (aiger * pub, const char *file_name,
+                                 aiger_and_sink sink, void *state)
+{
+  IMPORT_priv_FROM (pub);
+  const char *res;
+
+  assert (!aiger_error (pub));
+
+  priv->sink = sink;
+  priv->sink_state = state;
+
+  res = aiger_open_and_read_from_file (pub, file_name);
+
+  priv->sink = 0;
+  priv->sink_state = 0;
+
+  return res;
+}
+
+const char *
+aiger_stream_from_memory (aiger * pub, const char *data, size_t size,
+                          aiger_and_sink sink, void *state)
+{
+  IMPORT_priv_FROM (pub);
+  const char *res;
+
+  assert (!aiger_error (pub));
+
+  priv->sink = sink;
+  priv->sink_state = state;
+
+  res = aiger_read_from_memory (pub, data, size);
+
+  priv->sink = 0;
+  priv->sink_state = 0;
 
   return res;
 }
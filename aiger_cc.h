@@ -108,6 +108,13 @@ struct aiger_and
   unsigned rhs1;		/* as literal [0..2*maxvar+1] */
 };
 
+/*------------------------------------------------------------------------*/
+/* Callback function taking the next 'num_ands' ANDs of a streamed read in
+ * file order.  The ANDs are only valid during the call.
+ */
+typedef void (*aiger_and_sink) (void *client_state,
+                                const aiger_and *ands, unsigned num_ands);
+
 /*------------------------------------------------------------------------*/
 
 struct aiger_symbol
@@ -224,16 +231,6 @@ int aiger_is_reencoded (aiger *);
 void aiger_reencode (aiger *);
 
 
-/*------------------------------------------------------------------------*/
-/* This function computes the cone of influence (coi). The coi contains
- * those literals that may have an influence to one of the outputs.   A
- * variable 'v' is in the coi if the array returned as result is non zero at
- * position 'v'. All other variables can be considered redundant.  The array
- * returned is valid until the next call to this function and will be
- * deallocated on reset.
- */
-const unsigned char * aiger_coi (aiger *);		/* [1..maxvar] */
-
 /*------------------------------------------------------------------------*/
 /* Read an AIG from a FILE, a string, or through a generic interface.  These
  * functions return a non zero error message if an error occurred and
@@ -246,6 +243,12 @@ const char *aiger_read_from_file (aiger *, FILE *);
 const char *aiger_read_from_string (aiger *, const char *str);
 const char *aiger_read_generic (aiger *, void *state, aiger_get);
 
+/*------------------------------------------------------------------------*/
+/* Read an AIG from 'size' bytes at 'data', e.g. a mapped file.  The binary
+ * AND section is decoded in place without the character callback.
+ */
+const char *aiger_read_from_memory (aiger *, const char *data, size_t size);
+
 /*------------------------------------------------------------------------*/
 /* Returns a previously generated error message if the library is in an
  * invalid state.  After this function returns a non zero error message,
@@ -260,6 +263,37 @@ const char *aiger_error (aiger *);
  */
 const char *aiger_open_and_read_from_file (aiger *, const char *);
 
+/*------------------------------------------------------------------------*/
+/* Read inputs, latches and outputs as 'aiger_open_and_read_from_file' but
+ * pass the ANDs to 'sink' instead of storing them in 'ands'.  Binary ANDs
+ * are passed while decoding and never stored.  Since 'aiger_check' needs
+ * the ANDs it is not called, and checking that the ANDs are defined and
+ * acyclic is left to the client.
+ */
+const char *aiger_open_and_stream_from_file (aiger *, const char *,
+                                             aiger_and_sink, void *state);
+
+/*------------------------------------------------------------------------*/
+/* Same as 'aiger_open_and_stream_from_file' for 'size' bytes at 'data'.
+ * The data is not decompressed.
+ */
+const char *aiger_stream_from_memory (aiger *, const char *data, size_t size,
+                                      aiger_and_sink, void *state);
+
+/*------------------------------------------------------------------------*/
+/* The read functions skip the symbol table and comments.  This is the
+ * offset where they start, in the decompressed data for compressed files.
+ */
+size_t aiger_symbols_offset (aiger *);
+
+/*------------------------------------------------------------------------*/
+/* Read the bytes of 'file_name' from 'offset' on into a malloc'ed buffer,
+ * e.g. to load the symbol table later.  Compressed files are decompressed.
+ * The buffer has room for an additional byte.  Returns 0 on failure.
+ */
+char *aiger_read_tail (const char *file_name, size_t offset,
+                       size_t *size_ptr);
+
 /*------------------------------------------------------------------------*/
 /* Remove symbols and comments.  The result is the number of symbols
  * and comments removed.
@@ -292,14 +326,35 @@ aiger_and *aiger_is_and (aiger *, unsigned lit);
 
 #define USAGE \
 "\n" \
-"usage: sim [-h][-v][-c #cycles] src dst in \n" \
+"usage: sim [-h][-v][-O][-S #cycles][-m map][-o #output][-w aig][-C cache][-b][-e ilo][-B #cycles][-c #cycles][--stats[=file]][--counters][--profile[=file]][--engine=name][--cross-check] src [dst in] \n" \
+"       sim [options] -D socket [-j #workers] src... \n" \
+"       sim [-b][-e ilo][-c #cycles][-I] -J socket src dst in | -J socket -K \n" \
 "\n" \
 "  -h     print this command line option summary\n" \
 "  -v     verbose\n" \
-"  -c     # simulation cycles (default is 10,000)\n" \
+"  -O     optimize the aig before simulation\n" \
+"  -S     sweep equivalent latches and nodes, validated over # cycles\n" \
+"  -m     merge map file of -S (default is stdout)\n" \
+"  -o     observe output # or name only, may be repeated\n" \
+"  -w     write the reduced aig as binary aiger, dst and in are optional\n" \
+"  -C     program cache, built on a miss, skips loading on a hit unless -S\n" \
+"  -b     write dst as packed bit rows, tracepack -u makes it text\n" \
+"  -e     columns of dst, any of i(nputs), l(atches) and o(utputs)\n" \
+"  -B     cycles per block of the read/sim/write threads, 0 is one thread\n" \
+"  -c     # simulation cycles (default is 10,000), limits -J jobs only\n" \
+"  -D     serve jobs for the srcs on a Unix socket until stopped\n" \
+"  -j     # server workers (default is the number of processors)\n" \
+"  -J     run the simulation as a job of the server at socket\n" \
+"  -I     send the packed trace in with the job instead of its path\n" \
+"  -K     stop the server\n" \
+"  --stats write phase times, memory and counts as JSON to stderr or file\n" \
+"  --counters add hardware counters to --stats, per cycle and node evaluation\n" \
+"  --profile simulate with the reference engine, rank cones and ands by cost\n" \
+"  --engine compiled (default), lanes or recursive, the reference\n" \
+"  --cross-check check another engine against the reference, stop at a difference\n" \
 "  src    aiger file\n" \
-"  dst    output file\n" \
-"  in     intput trace file\n" \
+"  dst    output file, - is stdout for -J\n" \
+"  in     intput trace file, text or packed by tracepack\n" \
 "\n"
 
 aiger* read_aiger (const char* srcLocation);
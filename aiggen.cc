@@ -0,0 +1,248 @@
+#include <cstdlib>
+#include <cstdio>
+#include "aiggen.h"
+
+#define RANDOM_INPUTS 64
+#define RANDOM_OUTPUTS 64
+// fanins of random ands are taken from the nodes made last
+#define RANDOM_WINDOW 1024
+#define LFSR_OUTPUTS 64
+
+static inline uint64_t xorshift(uint64_t &s){
+  s ^= s << 13;
+  s ^= s >> 7;
+  s ^= s << 17;
+  return s;
+}
+
+AigGen::AigGen(AigDef &mgr, vector<AigNode*> &inputs, vector<AigNode*> &latches, vector<AigNode*> &latchLogic, vector<AigNode*> &outputs)
+  : mgr(mgr), inputs(inputs), latches(latches), latchLogic(latchLogic), outputs(outputs)
+{
+
+}
+
+AigGen::~AigGen()
+{
+
+}
+
+bool AigGen::generate(const string &spec){
+  string kind;
+  unsigned n, m = 0;
+  size_t colon;
+  char* end;
+
+  colon = spec.find(':');
+  if(colon == string::npos)
+    return false;
+
+  kind = spec.substr(0, colon);
+  n = strtoul(spec.c_str() + colon + 1, &end, 10);
+  if(*end == 'x')
+    m = strtoul(end + 1, &end, 10);
+  if(*end || !n)
+    return false;
+
+  if(kind == "random")
+    random(n, m ? m : 1);
+  else if(kind == "mult")
+    multiplier(n);
+  else if(kind == "adder")
+    adder(n);
+  else if(kind == "counter")
+    counter(n);
+  else if(kind == "shift" && m)
+    shifter(n, m);
+  else if(kind == "lfsr" && n > 1)
+    lfsr(n);
+  else
+    return false;
+
+  return true;
+}
+
+// Fanins are random edges to recent nodes, the next states and outputs
+// random edges to the last ands.  Structural hashing may merge a few.
+void AigGen::random(unsigned ands, unsigned seed){
+  unsigned i, numLatches = ands / 32 ? ands / 32 : 1;
+  uint64_t s = 0x9e3779b97f4a7c15ULL ^ seed;
+  vector<AigLit> pool;
+  AigLit a, b;
+
+  for(i = 0; i < RANDOM_INPUTS; i++)
+    pool.push_back(new_input());
+  for(i = 0; i < numLatches; i++)
+    pool.push_back(new_latch());
+
+  for(i = 0; i < ands; i++){
+    a = pool[pool.size() - 1 - xorshift(s) % (pool.size() < RANDOM_WINDOW ? pool.size() : RANDOM_WINDOW)];
+    b = pool[pool.size() - 1 - xorshift(s) % (pool.size() < RANDOM_WINDOW ? pool.size() : RANDOM_WINDOW)];
+    if(xorshift(s) & 1)
+      a = neg(a);
+    if(xorshift(s) & 1)
+      b = neg(b);
+    pool.push_back(and2(a, b));
+  }
+
+  for(i = 0; i < numLatches; i++)
+    set_next(i, pool[pool.size() - 1 - xorshift(s) % (ands < RANDOM_WINDOW ? ands : RANDOM_WINDOW)]);
+  for(i = 0; i < RANDOM_OUTPUTS; i++)
+    add_output(pool[pool.size() - 1 - xorshift(s) % (ands < RANDOM_WINDOW ? ands : RANDOM_WINDOW)]);
+}
+
+// rows of partial products added by ripple carry adders
+void AigGen::multiplier(unsigned bits){
+  unsigned i, j;
+  vector<AigLit> a, b, product(2 * bits, zero());
+  AigLit carry;
+
+  for(i = 0; i < bits; i++)
+    a.push_back(new_input());
+  for(i = 0; i < bits; i++)
+    b.push_back(new_input());
+
+  for(i = 0; i < bits; i++){
+    carry = zero();
+    for(j = 0; j < bits; j++)
+      full_add(product[i + j], and2(a[j], b[i]), carry, product[i + j], carry);
+    product[i + bits] = carry;
+  }
+
+  for(i = 0; i < 2 * bits; i++)
+    add_output(product[i]);
+}
+
+// sum += input every cycle, the outputs are the sum and the carry out
+void AigGen::adder(unsigned bits){
+  unsigned i;
+  vector<AigLit> in, sum;
+  AigLit carry, bit;
+
+  for(i = 0; i < bits; i++)
+    in.push_back(new_input());
+  for(i = 0; i < bits; i++)
+    sum.push_back(new_latch());
+
+  carry = zero();
+  for(i = 0; i < bits; i++){
+    full_add(sum[i], in[i], carry, bit, carry);
+    set_next(i, bit);
+    add_output(sum[i]);
+  }
+  add_output(carry);
+}
+
+void AigGen::counter(unsigned bits){
+  unsigned i;
+  vector<AigLit> count;
+  AigLit carry;
+
+  carry = new_input();
+  for(i = 0; i < bits; i++)
+    count.push_back(new_latch());
+
+  for(i = 0; i < bits; i++){
+    set_next(i, xor2(count[i], carry));
+    add_output(count[i]);
+    carry = and2(count[i], carry);
+  }
+  add_output(carry);
+}
+
+// each bank shifts its input in while enabled and holds otherwise
+void AigGen::shifter(unsigned banks, unsigned depth){
+  unsigned i, j;
+  AigLit enable, previous, stage;
+  vector<AigLit> data;
+
+  enable = new_input();
+  for(i = 0; i < banks; i++)
+    data.push_back(new_input());
+
+  for(i = 0; i < banks; i++){
+    previous = data[i];
+    for(j = 0; j < depth; j++){
+      stage = new_latch();
+      set_next(latches.size() - 1, mux(enable, previous, stage));
+      previous = stage;
+    }
+    add_output(previous);
+  }
+}
+
+// Fibonacci form with four taps, the input is xored into the feedback
+// so the register leaves the all zero state
+void AigGen::lfsr(unsigned bits){
+  unsigned i;
+  vector<AigLit> state;
+  AigLit feedback;
+
+  feedback = new_input();
+  for(i = 0; i < bits; i++)
+    state.push_back(new_latch());
+
+  feedback = xor2(feedback, xor2(xor2(state[bits - 1], state[bits * 3 / 4]), xor2(state[bits / 2], state[bits / 4])));
+  set_next(0, feedback);
+  for(i = 1; i < bits; i++)
+    set_next(i, state[i - 1]);
+
+  for(i = bits > LFSR_OUTPUTS ? bits - LFSR_OUTPUTS : 0; i < bits; i++)
+    add_output(state[i]);
+}
+
+AigLit AigGen::new_input(void){
+  AigNode* node = mgr.NewInputNode(mgr.getIndex());
+
+  inputs.push_back(node);
+  return mgr.NodeLit(node);
+}
+
+// the next state is set later, until then the latch holds 0
+AigLit AigGen::new_latch(void){
+  AigNode* node = mgr.NewLatchNode(mgr.getIndex());
+
+  latches.push_back(node);
+  latchLogic.push_back(mgr.Zero());
+  return mgr.NodeLit(node);
+}
+
+void AigGen::set_next(unsigned latch, AigLit next){
+  latchLogic[latch] = mgr.LitNode(next);
+}
+
+void AigGen::add_output(AigLit lit){
+  outputs.push_back(mgr.LitNode(lit));
+}
+
+AigLit AigGen::zero(void){
+  return mgr.NodeLit(mgr.Zero());
+}
+
+AigLit AigGen::neg(AigLit a){
+  a.pol = !a.pol;
+  return a;
+}
+
+AigLit AigGen::and2(AigLit a, AigLit b){
+  return mgr.AndLit(a, b);
+}
+
+AigLit AigGen::or2(AigLit a, AigLit b){
+  return neg(and2(neg(a), neg(b)));
+}
+
+AigLit AigGen::xor2(AigLit a, AigLit b){
+  return or2(and2(a, neg(b)), and2(neg(a), b));
+}
+
+// select ? a : b
+AigLit AigGen::mux(AigLit select, AigLit a, AigLit b){
+  return or2(and2(select, a), and2(neg(select), b));
+}
+
+void AigGen::full_add(AigLit a, AigLit b, AigLit c, AigLit &sum, AigLit &carry){
+  AigLit half = xor2(a, b);
+
+  sum = xor2(half, c);
+  carry = or2(and2(a, b), and2(c, half));
+}
@@ -0,0 +1,55 @@
+#ifndef AIGGEN_H
+#define AIGGEN_H
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include "aig.h"
+
+// Synthetic designs for benchmarks, built into an AigDef like AigLoad
+// does.  A spec is 'kind:n' or 'kind:nxm':
+//
+//   random:ands[xseed]    random dag over 64 inputs and ands/32 latches
+//   mult:bits             combinational array multiplier
+//   adder:bits            accumulator, one deep ripple carry chain
+//   counter:bits          counter with enable
+//   shift:banksxdepth     shift registers with a shared enable
+//   lfsr:bits             linear feedback shift register with an input
+class AigGen {
+
+public:
+  AigGen(AigDef &mgr, vector<AigNode*> &inputs, vector<AigNode*> &latches, vector<AigNode*> &latchLogic, vector<AigNode*> &outputs);
+  ~AigGen();
+
+  // false for an unknown kind or size
+  bool generate(const string &spec);
+
+  void random(unsigned ands, unsigned seed);
+  void multiplier(unsigned bits);
+  void adder(unsigned bits);
+  void counter(unsigned bits);
+  void shifter(unsigned banks, unsigned depth);
+  void lfsr(unsigned bits);
+
+private:
+  AigDef &mgr;
+  vector<AigNode*> &inputs;
+  vector<AigNode*> &latches;
+  vector<AigNode*> &latchLogic;
+  vector<AigNode*> &outputs;
+
+  AigLit new_input(void);
+  AigLit new_latch(void);
+  void set_next(unsigned latch, AigLit next);
+  void add_output(AigLit lit);
+
+  AigLit zero(void);
+  AigLit neg(AigLit a);
+  AigLit and2(AigLit a, AigLit b);
+  AigLit or2(AigLit a, AigLit b);
+  AigLit xor2(AigLit a, AigLit b);
+  AigLit mux(AigLit select, AigLit a, AigLit b);
+  void full_add(AigLit a, AigLit b, AigLit c, AigLit &sum, AigLit &carry);
+};
+
+#endif
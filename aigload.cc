@@ -0,0 +1,393 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include "aigload.h"
+
+#define NO_PENDING 0xffffffffu
+
+AigLoad::AigLoad(AigDef &mgr, vector<AigNode*> &inputs, vector<AigNode*> &latches, vector<AigNode*> &latchLogic, vector<AigNode*> &outputs)
+  : mgr(mgr), inputs(inputs), latches(latches), latchLogic(latchLogic), outputs(outputs)
+{
+  mem.bytes = mem.max = 0;
+  header = NULL;
+  started = false;
+  verbose = false;
+  ands = 0;
+  stats = NULL;
+}
+
+AigLoad::~AigLoad()
+{
+  if(header)
+    aiger_reset(header);
+}
+
+const string& AigLoad::error(void) const{
+  return message;
+}
+
+// names of the loaded file, indexed on first use
+AigSymbols& AigLoad::symbols(void){
+  return syms;
+}
+
+// Times reading and node creation as "parse", which are interleaved,
+// and the checks of the outputs and latches as "check".
+void AigLoad::setStats(AigStats* stats){
+  this->stats = stats;
+}
+
+// aiger reader allocation, current and peak
+const memory& AigLoad::memoryUse(void) const{
+  return mem;
+}
+
+// and nodes created
+unsigned AigLoad::numAnds(void) const{
+  return ands;
+}
+
+const vector<unsigned>& AigLoad::outputPositions(void) const{
+  return outputPos;
+}
+
+const vector<unsigned>& AigLoad::outputLiterals(void) const{
+  return outputLits;
+}
+
+// Read the file, with observed outputs, given by number or name, only their
+// cone of influence is kept.  Returns false with error() set if the file is
+// invalid.
+bool AigLoad::load(const char* fileName, vector<string> &observed, bool verbose){
+  const char* err;
+
+  this->verbose = verbose;
+  header = aiger_init_mem(&mem);
+
+  if(stats)
+    stats->begin("parse");
+
+  err = aiger_open_and_stream_from_file(header, fileName, sink, this);
+  if(err){
+    message = err;
+    return false;
+  }
+
+  return finish(fileName, observed);
+}
+
+// Same for an uncompressed file image.  It has no symbol table to look
+// output names up in later, outputs are observed by number only.
+bool AigLoad::loadMemory(const char* data, size_t size, vector<string> &observed, bool verbose){
+  const char* err;
+
+  this->verbose = verbose;
+  header = aiger_init_mem(&mem);
+
+  if(stats)
+    stats->begin("parse");
+
+  err = aiger_stream_from_memory(header, data, size, sink, this);
+  if(err){
+    message = err;
+    return false;
+  }
+
+  return finish("", observed);
+}
+
+bool AigLoad::finish(const char* fileName, vector<string> &observed){
+  unsigned i;
+  vector<unsigned> inputLits, latchLits, positions;
+
+  if(!started)
+    start();
+
+  if(!resolve_pending())
+    return false;
+
+  if(stats)
+    stats->begin("check");
+
+  if(verbose)
+    cout << "     * created " << ands << " and nodes" << endl;
+
+  for(i = 0; i < header->num_inputs; i++)
+    inputLits.push_back(header->inputs[i].lit);
+  for(i = 0; i < header->num_latches; i++)
+    latchLits.push_back(header->latches[i].lit);
+  syms.setSource(fileName, aiger_symbols_offset(header), inputLits, latchLits, header->num_outputs);
+
+  if(!resolve_outputs(observed, positions))
+    return false;
+
+  if(!connect(positions))
+    return false;
+
+  // only the nodes are left
+  aiger_reset(header);
+  header = NULL;
+  vector<AigNode*>().swap(varNode);
+  vector<aiger_and>().swap(pending);
+
+  if(stats)
+    stats->end();
+
+  return true;
+}
+
+void AigLoad::sink(void *state, const aiger_and *ands, unsigned num_ands){
+  ((AigLoad*) state)->add_ands(ands, num_ands);
+}
+
+// inputs and latches are known once the reader reaches the ANDs
+void AigLoad::start(void){
+  unsigned i, var;
+  AigNode* f;
+
+  started = true;
+  varNode.assign(header->maxvar + 1, NULL);
+  varNode[0] = mgr.Zero();
+
+  if(verbose)
+    cout << "     * creating " << header->num_inputs << " input nodes" << endl;
+
+  for(i = 0; i < header->num_inputs; i++){
+    var = aiger_lit2var(header->inputs[i].lit);
+    f = mgr.NewInputNode(var);
+    varNode[var] = f;
+    inputs.push_back(f);
+  }
+
+  if(verbose)
+    cout << "     * creating " << header->num_latches << " latch nodes" << endl;
+
+  for(i = 0; i < header->num_latches; i++){
+    var = aiger_lit2var(header->latches[i].lit);
+    f = mgr.NewLatchNode(var);
+    varNode[var] = f;
+    latches.push_back(f);
+  }
+}
+
+// ANDs with both fanins defined become nodes right away, which is always
+// the case in binary files
+void AigLoad::add_ands(const aiger_and *ands, unsigned num_ands){
+  unsigned i;
+  AigNode* left;
+  AigNode* right;
+
+  if(!started)
+    start();
+
+  for(i = 0; i < num_ands; i++){
+    left = varNode[aiger_lit2var(ands[i].rhs0)];
+    right = varNode[aiger_lit2var(ands[i].rhs1)];
+
+    if(!left || !right){
+      pending.push_back(ands[i]);
+      continue;
+    }
+
+    varNode[aiger_lit2var(ands[i].lhs)] = mgr.NewAndNode(left, aiger_sign(ands[i].rhs0), right, aiger_sign(ands[i].rhs1), aiger_lit2var(ands[i].lhs));
+    this->ands++;
+  }
+}
+
+// create the remaining ANDs fanins first, which also finds undefined
+// literals and cycles
+bool AigLoad::resolve_pending(void){
+  unsigned i, j, k, n, rhs;
+  vector<unsigned> pendingOf;
+  vector<unsigned char> mark;
+  vector<unsigned> stack;
+  aiger_and *a;
+
+  n = pending.size();
+  if(!n)
+    return true;
+
+  pendingOf.assign(header->maxvar + 1, NO_PENDING);
+  for(i = 0; i < n; i++)
+    pendingOf[aiger_lit2var(pending[i].lhs)] = i;
+
+  // 0 new, 1 on the stack, 2 created
+  mark.assign(n, 0);
+  for(i = 0; i < n; i++){
+    if(mark[i])
+      continue;
+
+    stack.push_back(i);
+    while(!stack.empty()){
+      j = stack.back();
+      a = &pending[j];
+
+      if(mark[j] == 2){
+        stack.pop_back();
+        continue;
+      }
+
+      if(mark[j] == 1){
+        varNode[aiger_lit2var(a->lhs)] = mgr.NewAndNode(varNode[aiger_lit2var(a->rhs0)], aiger_sign(a->rhs0), varNode[aiger_lit2var(a->rhs1)], aiger_sign(a->rhs1), aiger_lit2var(a->lhs));
+        ands++;
+        mark[j] = 2;
+        stack.pop_back();
+        continue;
+      }
+
+      mark[j] = 1;
+      for(k = 0; k < 2; k++){
+        rhs = k ? a->rhs1 : a->rhs0;
+        if(varNode[aiger_lit2var(rhs)])
+          continue;
+
+        if(pendingOf[aiger_lit2var(rhs)] == NO_PENDING)
+          return fail("literal %u in AND %u undefined", rhs, a->lhs);
+
+        if(mark[pendingOf[aiger_lit2var(rhs)]] == 1)
+          return fail("cyclic definition for and gate %u", aiger_lit2var(rhs), 0);
+
+        stack.push_back(pendingOf[aiger_lit2var(rhs)]);
+      }
+    }
+  }
+
+  return true;
+}
+
+// output numbers, names are looked up in the symbol table
+bool AigLoad::resolve_outputs(vector<string> &observed, vector<unsigned> &positions){
+  unsigned i, pos;
+
+  for(i = 0; i < observed.size(); i++){
+    if(isdigit(observed[i][0])){
+      pos = atoi(observed[i].c_str());
+      if(pos >= header->num_outputs)
+        return fail("invalid output %u", pos, 0);
+    }
+    else if(!syms.findOutput(observed[i].c_str(), pos)){
+      message = "unknown output " + observed[i];
+      return false;
+    }
+
+    positions.push_back(pos);
+  }
+
+  return true;
+}
+
+// next state functions and outputs, pinned to survive clean
+bool AigLoad::connect(vector<unsigned> &observed){
+  unsigned i, lit, numOutputs;
+  AigNode* node;
+  vector<AigNode*> next;
+
+  for(i = 0; i < header->num_latches; i++){
+    node = lit_node(header->latches[i].next);
+    if(!node)
+      return fail("next state function %u of latch %u undefined", header->latches[i].next, header->latches[i].lit);
+
+    next.push_back(node);
+  }
+
+  numOutputs = observed.empty() ? header->num_outputs : observed.size();
+
+  for(i = 0; i < header->num_outputs; i++)
+    outputLits.push_back(header->outputs[i].lit);
+
+  if(verbose)
+    cout << "     * creating " << numOutputs << " output nodes" << endl;
+
+  for(i = 0; i < numOutputs; i++){
+    lit = header->outputs[observed.empty() ? i : observed[i]].lit;
+    node = lit_node(lit);
+    if(!node)
+      return fail("output %u undefined", lit, 0);
+
+    outputs.push_back(node);
+    outputPos.push_back(observed.empty() ? i : observed[i]);
+  }
+
+  if(!observed.empty())
+    restrict_coi(next);
+
+  latchLogic = next;
+
+  // keep roots alive through clean
+  for(i = 0; i < latchLogic.size(); i++)
+    latchLogic[i]->ref_inc();
+
+  for(i = 0; i < outputs.size(); i++)
+    outputs[i]->ref_inc();
+
+  return true;
+}
+
+// drop the latches outside the cone of influence of the outputs, clean
+// removes the logic only they used
+void AigLoad::restrict_coi(vector<AigNode*> &next){
+  unsigned i, j;
+  AigNode* node;
+  vector<AigNode*> stack(outputs);
+  vector<AigNode*> visited;
+
+  // latch ids point to their next state function while traversing
+  for(i = 0; i < latches.size(); i++)
+    latches[i]->set_id(i + 1);
+
+  while(!stack.empty()){
+    node = stack.back();
+    stack.pop_back();
+
+    if(node->get_dependence() != NOTSET)
+      continue;
+
+    node->set_dependence(DEPENDENT);
+    visited.push_back(node);
+
+    if(node->is_latch())
+      stack.push_back(next[node->get_id() - 1]);
+    if(node->get_left())
+      stack.push_back(node->get_left());
+    if(node->get_right())
+      stack.push_back(node->get_right());
+  }
+
+  for(i = 0, j = 0; i < latches.size(); i++){
+    latches[i]->set_id(0);
+    if(latches[i]->get_dependence() == NOTSET)
+      continue;
+
+    latches[j] = latches[i];
+    next[j] = next[i];
+    j++;
+  }
+  latches.resize(j);
+  next.resize(j);
+
+  for(i = 0; i < visited.size(); i++)
+    visited[i]->set_dependence(NOTSET);
+}
+
+// node of a literal, complemented literals get an inverter
+AigNode* AigLoad::lit_node(unsigned lit){
+  AigNode* node;
+
+  if(lit == aiger_true)
+    return mgr.One();
+
+  node = varNode[aiger_lit2var(lit)];
+  if(node && aiger_sign(lit))
+    node = mgr.NewAndNode(node, true, mgr.One(), false);
+
+  return node;
+}
+
+bool AigLoad::fail(const char* format, unsigned a, unsigned b){
+  char buffer[128];
+
+  sprintf(buffer, format, a, b);
+  message = buffer;
+  return false;
+}
@@ -0,0 +1,67 @@
+#ifndef AIGLOAD_H
+#define AIGLOAD_H
+
+#include <vector>
+#include <string>
+#include "aig.h"
+#include "aiger_cc.h"
+#include "aigsym.h"
+#include "aigstats.h"
+
+// Reads an aiger file straight into an AigDef.  The ANDs are streamed from
+// the reader into nodes and never stored, definedness and cycles are
+// checked on the way.
+class AigLoad {
+
+public:
+  AigLoad(AigDef &mgr, vector<AigNode*> &inputs, vector<AigNode*> &latches, vector<AigNode*> &latchLogic, vector<AigNode*> &outputs);
+  ~AigLoad();
+
+  bool load(const char* fileName, vector<string> &observed, bool verbose);
+  bool loadMemory(const char* data, size_t size, vector<string> &observed, bool verbose);
+  const string& error(void) const;
+  AigSymbols& symbols(void);
+  void setStats(AigStats* stats);
+  const memory& memoryUse(void) const;
+  unsigned numAnds(void) const;
+  const vector<unsigned>& outputPositions(void) const;
+  const vector<unsigned>& outputLiterals(void) const;
+
+private:
+  AigDef &mgr;
+  vector<AigNode*> &inputs;
+  vector<AigNode*> &latches;
+  vector<AigNode*> &latchLogic;
+  vector<AigNode*> &outputs;
+
+  memory mem;
+  aiger* header;
+  bool started;
+  bool verbose;
+  unsigned ands;
+  string message;
+  AigSymbols syms;
+  AigStats* stats;
+  // position in the file of each output
+  vector<unsigned> outputPos;
+  // literal of every output of the file, by position
+  vector<unsigned> outputLits;
+
+  // node of each aiger variable
+  vector<AigNode*> varNode;
+  // ASCII ANDs read before their fanins
+  vector<aiger_and> pending;
+
+  bool finish(const char* fileName, vector<string> &observed);
+  static void sink(void *state, const aiger_and *ands, unsigned num_ands);
+  void start(void);
+  void add_ands(const aiger_and *ands, unsigned num_ands);
+  bool resolve_pending(void);
+  bool resolve_outputs(vector<string> &observed, vector<unsigned> &positions);
+  bool connect(vector<unsigned> &observed);
+  void restrict_coi(vector<AigNode*> &next);
+  AigNode* lit_node(unsigned lit);
+  bool fail(const char* format, unsigned a, unsigned b);
+};
+
+#endif
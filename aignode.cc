@@ -21,6 +21,8 @@ AigNode::AigNode(unsigned index, bool out_pol, AigNode* left, bool left_pol, Aig
   }
 
   this->index = index;
+  this->id = 0;
+  this->level = 0;
   this->refcount = 0;
   this->out_pol = out_pol;
   this->dependence = (DependenceStatus)0;
@@ -38,6 +40,8 @@ AigNode::AigNode(unsigned index, bool out_pol, AigNode* left, bool left_pol, Aig
 AigNode::AigNode(unsigned index)
 {
   this->index = index;
+  this->id = 0;
+  this->level = 0;
   this->left = 0;
   this->left_pol = false;
   this->right = 0;
@@ -144,6 +148,14 @@ unsigned AigNode::get_type(void) const{
   return this->nodeType;
 }
 
+unsigned AigNode::get_id(void) const{
+  return this->id;
+}
+
+unsigned AigNode::get_level(void) const{
+  return this->level;
+}
+
 unsigned AigNode::get_dependence() const{
   return this->dependence;
 }
@@ -153,6 +165,14 @@ unsigned AigNode::set_dependence(DependenceStatus status){
   this->dependence = status;
 }
 
+void AigNode::set_id(unsigned id){
+  this->id = id;
+}
+
+void AigNode::set_level(unsigned level){
+  this->level = level;
+}
+
 bool AigNode::is_const() const{
   return this->nodeType == AIGCONST;
 }
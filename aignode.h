@@ -54,6 +54,8 @@ public:
   unsigned get_type(void) const;
   AigNode* get_left(void) const;
   AigNode* get_right(void) const;
+  unsigned get_id(void) const;
+  unsigned get_level(void) const;
 
   bool operator==(const AigNode& other) const;
   size_t hash_key(void) const;
@@ -62,6 +64,8 @@ public:
   unsigned ref_dec(void);
 
   unsigned set_dependence(DependenceStatus status);
+  void set_id(unsigned id);
+  void set_level(unsigned level);
 
   bool is_const() const;
   bool is_input() const;
@@ -72,6 +76,8 @@ public:
 private:
   unsigned refcount;
   unsigned index;
+  unsigned id;
+  unsigned level;
   bool left_pol;
   bool right_pol;
   bool out_pol;
@@ -0,0 +1,587 @@
+#include <iostream>
+#include <algorithm>
+#include "aigopt.h"
+
+#define MAX_CUTS 8
+
+static const unsigned var_mask[4] = { 0xAAAA, 0xCCCC, 0xF0F0, 0xFF00 };
+
+static unsigned cofactor0(unsigned truth, unsigned var)
+{
+  truth &= ~var_mask[var] & 0xFFFF;
+  return truth | (truth << (1 << var));
+}
+
+static unsigned cofactor1(unsigned truth, unsigned var)
+{
+  truth &= var_mask[var];
+  return truth | (truth >> (1 << var));
+}
+
+// Minato-Morreale irredundant sum of products between 'on' and 'upper'.
+// Cubes use bit 2v for a positive and bit 2v+1 for a negative literal.
+static unsigned isop(unsigned on, unsigned upper, int var, unsigned cube, vector<unsigned> &cover)
+{
+  unsigned on0, on1, up0, up1, f0, f1, rest, fs;
+
+  if(on == 0)
+    return 0;
+
+  if(upper == 0xFFFF){
+    cover.push_back(cube);
+    return 0xFFFF;
+  }
+
+  while(var > 0 && cofactor0(on, var) == cofactor1(on, var) && cofactor0(upper, var) == cofactor1(upper, var))
+    var--;
+
+  on0 = cofactor0(on, var);
+  on1 = cofactor1(on, var);
+  up0 = cofactor0(upper, var);
+  up1 = cofactor1(upper, var);
+
+  f0 = isop(on0 & ~up1 & 0xFFFF, up0, var - 1, cube | (2 << (2 * var)), cover);
+  f1 = isop(on1 & ~up0 & 0xFFFF, up1, var - 1, cube | (1 << (2 * var)), cover);
+  rest = ((on0 & ~f0) | (on1 & ~f1)) & 0xFFFF;
+  fs = isop(rest, up0 & up1, var - 1, cube, cover);
+
+  return ((f0 & ~var_mask[var]) | (f1 & var_mask[var]) | fs) & 0xFFFF;
+}
+
+// number of 'and' nodes of a factored cover
+static unsigned cover_cost(vector<unsigned> &cover)
+{
+  unsigned i, v, lits, cost;
+
+  cost = cover.size() - 1;
+  for(i = 0; i < cover.size(); i++){
+    lits = 0;
+    for(v = 0; v < 8; v++)
+      if(cover[i] & (1 << v))
+        lits++;
+    if(lits)
+      cost += lits - 1;
+  }
+
+  return cost;
+}
+
+// truth table of 'cut' over the leaves of its superset 'super'
+static unsigned expand_truth(const AigCut &cut, const AigCut &super)
+{
+  unsigned i, j, m, idx, res;
+  unsigned pos[4];
+
+  for(i = 0; i < cut.size; i++){
+    for(j = 0; super.leaves[j] != cut.leaves[i]; j++)
+      ;
+    pos[i] = j;
+  }
+
+  res = 0;
+  for(m = 0; m < 16; m++){
+    idx = 0;
+    for(i = 0; i < cut.size; i++)
+      if((m >> pos[i]) & 1)
+        idx |= 1 << i;
+    if((cut.truth >> idx) & 1)
+      res |= 1 << m;
+  }
+
+  return res;
+}
+
+// drop leaves outside the support of the truth table
+static void minimize_cut(AigCut &cut)
+{
+  unsigned i, j, m, old, truth;
+
+  for(i = cut.size; i-- > 0;){
+    if(cofactor0(cut.truth, i) != cofactor1(cut.truth, i))
+      continue;
+
+    truth = 0;
+    for(m = 0; m < 16; m++){
+      old = ((m & ((1 << i) - 1)) | ((m >> i) << (i + 1))) & 15;
+      if((cut.truth >> old) & 1)
+        truth |= 1 << m;
+    }
+    cut.truth = truth;
+
+    for(j = i; j + 1 < cut.size; j++)
+      cut.leaves[j] = cut.leaves[j + 1];
+    cut.size--;
+  }
+}
+
+static bool merge_leaves(const AigCut &a, const AigCut &b, AigCut &res)
+{
+  unsigned i, j;
+
+  i = j = 0;
+  res.size = 0;
+  while(i < a.size || j < b.size){
+    if(res.size == 4)
+      return false;
+
+    if(j == b.size || (i < a.size && a.leaves[i] < b.leaves[j]))
+      res.leaves[res.size++] = a.leaves[i++];
+    else if(i == a.size || b.leaves[j] < a.leaves[i])
+      res.leaves[res.size++] = b.leaves[j++];
+    else{
+      res.leaves[res.size++] = a.leaves[i++];
+      j++;
+    }
+  }
+
+  return true;
+}
+
+// 'a' contains all leaves of 'b'
+static bool cut_contains(const AigCut &a, const AigCut &b)
+{
+  unsigned i, j;
+
+  for(i = 0; i < b.size; i++){
+    for(j = 0; j < a.size && a.leaves[j] != b.leaves[i]; j++)
+      ;
+    if(j == a.size)
+      return false;
+  }
+
+  return true;
+}
+
+static bool lit_less(const AigLit &a, const AigLit &b)
+{
+  if(a.node != b.node)
+    return a.node < b.node;
+
+  return a.pol < b.pol;
+}
+
+static bool level_greater(const AigLit &a, const AigLit &b)
+{
+  return a.node->get_level() > b.node->get_level();
+}
+
+bool AigCut::operator<(const AigCut& other) const
+{
+  unsigned i;
+
+  if(size != other.size)
+    return size < other.size;
+
+  for(i = 0; i < size; i++)
+    if(leaves[i] != other.leaves[i])
+      return leaves[i] < other.leaves[i];
+
+  return truth < other.truth;
+}
+
+AigOpt::AigOpt(AigDef &mgr, vector<AigNode*> &inputs, vector<AigNode*> &latches, vector<AigNode*> &latchLogic, vector<AigNode*> &outputs)
+  : mgr(mgr), inputs(inputs), latches(latches), latchLogic(latchLogic), outputs(outputs)
+{
+  ands = 0;
+  levels = 0;
+}
+
+AigOpt::~AigOpt()
+{
+
+}
+
+// run redundancy removal, rewriting and balancing, summary reports the
+// result
+void AigOpt::optimize(bool verbose, bool summary){
+  unsigned startAnds, startLevels;
+
+  renumber();
+  startAnds = ands;
+  startLevels = levels;
+
+  removeRedundancy();
+  if(verbose)
+    cout << "     * redundancy removal: " << ands << " nodes, " << levels << " levels" << endl;
+
+  rewrite();
+  if(verbose)
+    cout << "     * rewriting: " << ands << " nodes, " << levels << " levels" << endl;
+
+  balance();
+  if(verbose)
+    cout << "     * balancing: " << ands << " nodes, " << levels << " levels" << endl;
+
+  if(summary)
+    cout << "nodes: " << startAnds << " -> " << ands << ", levels: " << startLevels << " -> " << levels << endl;
+}
+
+void AigOpt::removeRedundancy(void){
+  cut_pass(false);
+}
+
+void AigOpt::rewrite(void){
+  cut_pass(true);
+}
+
+// rebuild and trees as balanced trees over their leaves
+void AigOpt::balance(void){
+  unsigned id, n;
+  AigNode* node;
+  AigNode* child;
+  bool pol;
+  vector<pair<AigNode*, bool> > stack;
+  vector<AigLit> leaves;
+
+  renumber();
+  n = mgr.numNodeIds();
+
+  // single fanout children on uncomplemented edges join their parent tree
+  vector<bool> absorbed(n, false);
+  for(id = 0; id < n; id++){
+    node = mgr.idNode(id);
+    if(!node->is_and())
+      continue;
+
+    child = node->get_left();
+    if(!node->get_lpol() && child->is_and() && mgr.fanoutCount(child->get_id()) == 1)
+      absorbed[child->get_id()] = true;
+
+    child = node->get_right();
+    if(!node->get_rpol() && child->is_and() && mgr.fanoutCount(child->get_id()) == 1)
+      absorbed[child->get_id()] = true;
+  }
+
+  vector<AigLit> newLit(n);
+  for(id = 0; id < n; id++){
+    node = mgr.idNode(id);
+    if(!node->is_and()){
+      newLit[id] = mgr.NodeLit(node);
+      continue;
+    }
+    else if(absorbed[id])
+      continue;
+
+    leaves.clear();
+    stack.push_back(make_pair(node->get_left(), node->get_lpol()));
+    stack.push_back(make_pair(node->get_right(), node->get_rpol()));
+    while(!stack.empty()){
+      child = stack.back().first;
+      pol = stack.back().second;
+      stack.pop_back();
+
+      if(!pol && absorbed[child->get_id()]){
+        stack.push_back(make_pair(child->get_left(), child->get_lpol()));
+        stack.push_back(make_pair(child->get_right(), child->get_rpol()));
+      }
+      else
+        leaves.push_back(child_lit(newLit, child, pol));
+    }
+
+    newLit[id] = build_and(leaves);
+  }
+
+  replace_roots(newLit);
+}
+
+// merge nodes with equal cut functions, replace cones by cheaper covers
+void AigOpt::cut_pass(bool rewriting){
+  unsigned id, i, n, flip, mffc, cost, bestGain;
+  int best;
+  AigNode* node;
+  AigCut key;
+  AigLit lit;
+  vector<unsigned> cover0, cover1;
+  map<AigCut, AigLit> classes;
+  map<AigCut, AigLit>::iterator it;
+
+  renumber();
+  n = mgr.numNodeIds();
+  bestGain = 0;
+
+  vector<vector<AigCut> > cuts(n);
+  vector<AigLit> newLit(n);
+
+  for(id = 0; id < n; id++){
+    node = mgr.idNode(id);
+
+    if(!node->is_and()){
+      newLit[id] = mgr.NodeLit(node);
+      key.size = 1;
+      key.leaves[0] = id;
+      key.truth = 0xAAAA;
+      if(node == mgr.Zero() || node == mgr.One()){
+        key.size = 0;
+        key.truth = (node == mgr.One()) ? 0xFFFF : 0;
+      }
+      cuts[id].push_back(key);
+      continue;
+    }
+
+    enumerate_cuts(id, cuts);
+    newLit[id] = mgr.AndLit(child_lit(newLit, node->get_left(), node->get_lpol()), child_lit(newLit, node->get_right(), node->get_rpol()));
+
+    // constants, buffers and previously seen functions
+    best = -1;
+    for(i = 1; i < cuts[id].size(); i++){
+      AigCut &cut = cuts[id][i];
+
+      if(cut.size == 0){
+        newLit[id].node = mgr.Zero();
+        newLit[id].pol = (cut.truth != 0);
+        break;
+      }
+
+      if(cut.size == 1){
+        newLit[id] = newLit[cut.leaves[0]];
+        newLit[id].pol ^= (cut.truth == 0x5555);
+        break;
+      }
+
+      key = cut;
+      flip = key.truth & 1;
+      if(flip)
+        key.truth = ~key.truth & 0xFFFF;
+
+      it = classes.find(key);
+      if(it != classes.end()){
+        newLit[id] = it->second;
+        newLit[id].pol ^= flip;
+        break;
+      }
+
+      if(!rewriting)
+        continue;
+
+      cover0.clear();
+      cover1.clear();
+      isop(cut.truth, cut.truth, 3, 0, cover0);
+      isop(~cut.truth & 0xFFFF, ~cut.truth & 0xFFFF, 3, 0, cover1);
+      cost = min(cover_cost(cover0), cover_cost(cover1));
+      mffc = mffc_size(id, cut);
+
+      if(cost < mffc && (best < 0 || mffc - cost > bestGain)){
+        best = i;
+        bestGain = mffc - cost;
+      }
+    }
+
+    if(i == cuts[id].size() && best >= 0)
+      newLit[id] = build_sop(cuts[id][best].truth, cuts[id][best], newLit);
+
+    // record the functions of this node
+    for(i = 1; i < cuts[id].size(); i++){
+      key = cuts[id][i];
+      if(key.size < 2)
+        continue;
+
+      lit = newLit[id];
+      if(key.truth & 1){
+        key.truth = ~key.truth & 0xFFFF;
+        lit.pol = !lit.pol;
+      }
+      classes.insert(make_pair(key, lit));
+    }
+  }
+
+  replace_roots(newLit);
+}
+
+// cuts of an 'and' node from the cuts of its children, trivial cut first
+void AigOpt::enumerate_cuts(unsigned id, vector<vector<AigCut> > &cuts){
+  unsigned i, j, k, a, b;
+  unsigned ta, tb;
+  bool dominated;
+  AigNode* node = mgr.idNode(id);
+  AigCut cut;
+  vector<AigCut> &res = cuts[id];
+
+  a = node->get_left()->get_id();
+  b = node->get_right()->get_id();
+
+  cut.size = 1;
+  cut.leaves[0] = id;
+  cut.truth = 0xAAAA;
+  res.push_back(cut);
+
+  for(i = 0; i < cuts[a].size() && res.size() <= MAX_CUTS; i++){
+    for(j = 0; j < cuts[b].size() && res.size() <= MAX_CUTS; j++){
+      if(!merge_leaves(cuts[a][i], cuts[b][j], cut))
+        continue;
+
+      ta = expand_truth(cuts[a][i], cut);
+      tb = expand_truth(cuts[b][j], cut);
+      if(node->get_lpol())
+        ta = ~ta & 0xFFFF;
+      if(node->get_rpol())
+        tb = ~tb & 0xFFFF;
+
+      cut.truth = ta & tb;
+      minimize_cut(cut);
+
+      dominated = false;
+      for(k = 1; k < res.size() && !dominated; k++)
+        dominated = cut_contains(cut, res[k]);
+      if(!dominated)
+        res.push_back(cut);
+    }
+  }
+}
+
+// 'and' nodes freed when the cone of 'id' above 'cut' is replaced
+unsigned AigOpt::mffc_size(unsigned id, AigCut &cut){
+  unsigned i, count;
+  AigNode* node;
+  AigNode* child;
+  vector<AigNode*> stack;
+
+  count = 0;
+  stack.push_back(mgr.idNode(id));
+  while(!stack.empty()){
+    node = stack.back();
+    stack.pop_back();
+    count++;
+
+    for(i = 0; i < 2; i++){
+      child = i ? node->get_right() : node->get_left();
+      if(!child->is_and() || mgr.fanoutCount(child->get_id()) != 1)
+        continue;
+      if(find(cut.leaves, cut.leaves + cut.size, child->get_id()) != cut.leaves + cut.size)
+        continue;
+
+      stack.push_back(child);
+    }
+  }
+
+  return count;
+}
+
+// factored sum of products of the cheaper polarity
+AigLit AigOpt::build_sop(unsigned truth, AigCut &cut, vector<AigLit> &newLit){
+  unsigned i, v;
+  bool compl_cover;
+  AigLit lit, res;
+  vector<unsigned> cover0, cover1;
+  vector<AigLit> lits, cubes;
+
+  isop(truth, truth, 3, 0, cover0);
+  isop(~truth & 0xFFFF, ~truth & 0xFFFF, 3, 0, cover1);
+  compl_cover = cover_cost(cover1) < cover_cost(cover0);
+  vector<unsigned> &cover = compl_cover ? cover1 : cover0;
+
+  for(i = 0; i < cover.size(); i++){
+    lits.clear();
+    for(v = 0; v < cut.size; v++){
+      lit = newLit[cut.leaves[v]];
+      if(cover[i] & (1 << (2 * v)))
+        lits.push_back(lit);
+      if(cover[i] & (2 << (2 * v))){
+        lit.pol = !lit.pol;
+        lits.push_back(lit);
+      }
+    }
+
+    // or of cubes as the complement of an 'and' of complemented cubes
+    lit = build_and(lits);
+    lit.pol = !lit.pol;
+    cubes.push_back(lit);
+  }
+
+  res = build_and(cubes);
+  res.pol = !res.pol;
+  if(compl_cover)
+    res.pol = !res.pol;
+
+  return res;
+}
+
+// balanced 'and' of edges, lowest levels are combined first
+AigLit AigOpt::build_and(vector<AigLit> &lits){
+  unsigned i, j;
+  AigLit res, left, right;
+
+  res.node = mgr.Zero();
+  res.pol = true;
+  if(lits.empty())
+    return res;
+
+  sort(lits.begin(), lits.end(), lit_less);
+  for(i = 0, j = 0; i < lits.size(); i++){
+    if(lits[i].node == mgr.Zero()){
+      if(!lits[i].pol)
+        return lits[i];
+      continue;
+    }
+
+    if(j > 0 && lits[j - 1].node == lits[i].node){
+      if(lits[j - 1].pol != lits[i].pol){
+        res.pol = false;
+        return res;
+      }
+      continue;
+    }
+
+    lits[j++] = lits[i];
+  }
+  lits.resize(j);
+
+  if(lits.empty())
+    return res;
+
+  while(lits.size() > 1){
+    sort(lits.begin(), lits.end(), level_greater);
+    right = lits.back();
+    lits.pop_back();
+    left = lits.back();
+    lits.pop_back();
+    lits.push_back(mgr.AndLit(left, right));
+  }
+
+  return lits[0];
+}
+
+AigLit AigOpt::child_lit(vector<AigLit> &newLit, AigNode* child, bool pol){
+  AigLit lit = newLit[child->get_id()];
+
+  if(pol)
+    lit.pol = !lit.pol;
+
+  return lit;
+}
+
+// point latch and output roots at the rebuilt graph and drop the old one
+void AigOpt::replace_roots(vector<AigLit> &newLit){
+  unsigned i;
+  AigNode* node;
+
+  for(i = 0; i < latchLogic.size(); i++){
+    node = mgr.LitNode(child_lit(newLit, latchLogic[i], false));
+    node->ref_inc();
+    latchLogic[i]->ref_dec();
+    latchLogic[i] = node;
+  }
+
+  for(i = 0; i < outputs.size(); i++){
+    node = mgr.LitNode(child_lit(newLit, outputs[i], false));
+    node->ref_inc();
+    outputs[i]->ref_dec();
+    outputs[i] = node;
+  }
+
+  mgr.clean();
+  renumber();
+}
+
+void AigOpt::renumber(void){
+  mgr.buildFanout(inputs, latches, latchLogic, outputs);
+  levels = mgr.levelize();
+  ands = mgr.numNodeIds() - 2 - inputs.size() - latches.size();
+}
+
+unsigned AigOpt::andCount(void) const {
+  return ands;
+}
+
+unsigned AigOpt::levelCount(void) const {
+  return levels;
+}
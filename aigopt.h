@@ -0,0 +1,52 @@
+#ifndef AIGOPT_H
+#define AIGOPT_H
+
+#include <vector>
+#include <map>
+#include "aig.h"
+
+// cut of at most four leaves with the truth table of its root
+struct AigCut
+{
+  unsigned size;
+  unsigned leaves[4];
+  unsigned truth;
+
+  bool operator<(const AigCut& other) const;
+};
+
+class AigOpt {
+
+public:
+  AigOpt(AigDef &mgr, vector<AigNode*> &inputs, vector<AigNode*> &latches, vector<AigNode*> &latchLogic, vector<AigNode*> &outputs);
+  ~AigOpt();
+
+  void optimize(bool verbose, bool summary);
+  void removeRedundancy(void);
+  void rewrite(void);
+  void balance(void);
+
+  unsigned andCount(void) const;
+  unsigned levelCount(void) const;
+
+private:
+  AigDef &mgr;
+  vector<AigNode*> &inputs;
+  vector<AigNode*> &latches;
+  vector<AigNode*> &latchLogic;
+  vector<AigNode*> &outputs;
+  unsigned ands;
+  unsigned levels;
+
+  void renumber(void);
+  void cut_pass(bool rewriting);
+  void replace_roots(vector<AigLit> &newLit);
+  AigLit child_lit(vector<AigLit> &newLit, AigNode* child, bool pol);
+
+  void enumerate_cuts(unsigned id, vector<vector<AigCut> > &cuts);
+  unsigned mffc_size(unsigned id, AigCut &cut);
+  AigLit build_sop(unsigned truth, AigCut &cut, vector<AigLit> &newLit);
+  AigLit build_and(vector<AigLit> &lits);
+};
+
+#endif
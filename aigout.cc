@@ -0,0 +1,303 @@
+#include <fstream>
+#include <cstring>
+#include <cstddef>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "aigout.h"
+
+#define ASCII_ZEROS 0x3030303030303030ULL
+
+AigOutput::AigOutput()
+{
+  fd = -1;
+  memory = NULL;
+  packed = false;
+  columns = COLUMN_ALL;
+  numInputs = numLatches = numOutputs = 0;
+  rowBytes = 0;
+  numCycles = 0;
+  failed = false;
+  used = 0;
+}
+
+AigOutput::~AigOutput()
+{
+  if(fd >= 0 || memory)
+    close();
+}
+
+bool AigOutput::open(const string &fileName, bool packed, unsigned columns, unsigned numInputs, unsigned numLatches, unsigned numOutputs){
+  fd = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if(fd < 0){
+    message = "Unable to open file " + fileName;
+    return false;
+  }
+
+  memory = NULL;
+  start(packed, columns, numInputs, numLatches, numOutputs);
+  return true;
+}
+
+// Appends the output to memory instead of a file.
+void AigOutput::open(vector<char>* memory, bool packed, unsigned columns, unsigned numInputs, unsigned numLatches, unsigned numOutputs){
+  fd = -1;
+  this->memory = memory;
+  memory->clear();
+  start(packed, columns, numInputs, numLatches, numOutputs);
+}
+
+void AigOutput::start(bool packed, unsigned columns, unsigned numInputs, unsigned numLatches, unsigned numOutputs){
+  AigOutputHeader h;
+  size_t maxRow;
+  unsigned bits;
+
+  this->packed = packed;
+  this->columns = columns;
+  this->numInputs = (columns & COLUMN_INPUTS) ? numInputs : 0;
+  this->numLatches = (columns & COLUMN_LATCHES) ? numLatches : 0;
+  this->numOutputs = (columns & COLUMN_OUTPUTS) ? numOutputs : 0;
+  numCycles = 0;
+  failed = false;
+  used = 0;
+
+  bits = this->numInputs + this->numLatches + this->numOutputs;
+  rowBytes = (bits + 63) / 64 * sizeof(uint64_t);
+
+  // a cycle always fits
+  maxRow = packed ? rowBytes : bits + 3;
+  buffer.resize(maxRow > OUTPUT_BUFFER_SIZE ? maxRow : OUTPUT_BUFFER_SIZE);
+
+  if(packed){
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, OUTPUT_MAGIC, sizeof(h.magic));
+    h.version = OUTPUT_VERSION;
+    h.columns = columns;
+    h.numInputs = this->numInputs;
+    h.numLatches = this->numLatches;
+    h.numOutputs = this->numOutputs;
+    h.rowWords = rowBytes / sizeof(uint64_t);
+    memcpy(&buffer[0], &h, sizeof(h));
+    used = sizeof(h);
+  }
+}
+
+// Appends one cycle, columns that are not selected are ignored.
+void AigOutput::write(const unsigned char* inputs, const unsigned char* latches, const unsigned char* outputs){
+  unsigned bit;
+  bool first;
+
+  if(used + (packed ? rowBytes : numInputs + numLatches + numOutputs + 3) > buffer.size())
+    flush();
+
+  numCycles++;
+
+  if(packed){
+    memset(&buffer[used], 0, rowBytes);
+    bit = 0;
+    put_bits(inputs, numInputs, bit);
+    put_bits(latches, numLatches, bit);
+    put_bits(outputs, numOutputs, bit);
+    used += rowBytes;
+    return;
+  }
+
+  first = true;
+  if(columns & COLUMN_INPUTS){
+    put_text(inputs, numInputs);
+    first = false;
+  }
+  if(columns & COLUMN_LATCHES){
+    if(!first)
+      buffer[used++] = ' ';
+    put_text(latches, numLatches);
+    first = false;
+  }
+  if(columns & COLUMN_OUTPUTS){
+    if(!first)
+      buffer[used++] = ' ';
+    put_text(outputs, numOutputs);
+  }
+  buffer[used++] = '\n';
+}
+
+// Writes what is left and the cycle count of packed files.  False with
+// error() set if any write failed.
+bool AigOutput::close(void){
+  uint64_t cycles = numCycles;
+
+  if(fd < 0 && !memory)
+    return !failed;
+
+  flush();
+
+  if(memory){
+    if(packed)
+      memcpy(&(*memory)[offsetof(AigOutputHeader, numCycles)], &cycles, sizeof(cycles));
+    memory = NULL;
+    return true;
+  }
+
+  if(packed && !failed && pwrite(fd, &cycles, sizeof(cycles), offsetof(AigOutputHeader, numCycles)) != sizeof(cycles)){
+    failed = true;
+    message = "Unable to write output file";
+  }
+
+  if(::close(fd) && !failed){
+    failed = true;
+    message = "Unable to write output file";
+  }
+  fd = -1;
+
+  return !failed;
+}
+
+const string& AigOutput::error(void) const{
+  return message;
+}
+
+// any of 'i', 'l' and 'o'
+bool AigOutput::parseColumns(const char* str, unsigned &columns){
+  columns = 0;
+
+  for(; *str; str++){
+    if(*str == 'i')
+      columns |= COLUMN_INPUTS;
+    else if(*str == 'l')
+      columns |= COLUMN_LATCHES;
+    else if(*str == 'o')
+      columns |= COLUMN_OUTPUTS;
+    else
+      return false;
+  }
+
+  return columns != 0;
+}
+
+bool AigOutput::isPacked(const string &fileName){
+  char magic[8];
+  int fd;
+  bool packed;
+
+  fd = ::open(fileName.c_str(), O_RDONLY);
+  if(fd < 0)
+    return false;
+
+  packed = read(fd, magic, sizeof(magic)) == sizeof(magic) && !memcmp(magic, OUTPUT_MAGIC, sizeof(magic));
+  ::close(fd);
+
+  return packed;
+}
+
+// the text lines sim would have written for the same columns
+bool AigOutput::unpack(const string &packedFile, const string &textFile, string &error){
+  AigOutputHeader h;
+  AigOutput text;
+  struct stat st;
+  uint64_t c;
+  unsigned n, bit;
+  vector<uint64_t> row;
+  vector<unsigned char> values;
+
+  ifstream in(packedFile.c_str(), ios::in | ios::binary);
+  if(!in.is_open()){
+    error = "Unable to open file " + packedFile;
+    return false;
+  }
+
+  if(!in.read((char*) &h, sizeof(h)) || memcmp(h.magic, OUTPUT_MAGIC, sizeof(h.magic)) || h.version != OUTPUT_VERSION || stat(packedFile.c_str(), &st)){
+    error = "Invalid packed output " + packedFile;
+    return false;
+  }
+
+  n = h.numInputs + h.numLatches + h.numOutputs;
+  if(h.rowWords != (n + 63) / 64
+     || (h.rowWords && h.numCycles > (uint64_t) (st.st_size - sizeof(h)) / (h.rowWords * sizeof(uint64_t)))
+     || (uint64_t) st.st_size != sizeof(h) + h.numCycles * h.rowWords * sizeof(uint64_t)){
+    error = "Invalid packed output " + packedFile;
+    return false;
+  }
+
+  if(!text.open(textFile, false, h.columns, h.numInputs, h.numLatches, h.numOutputs)){
+    error = text.error();
+    return false;
+  }
+
+  row.resize(h.rowWords + 1);
+  values.resize(n + 1);
+  for(c = 0; c < h.numCycles; c++){
+    in.read((char*) &row[0], h.rowWords * sizeof(uint64_t));
+    for(bit = 0; bit < n; bit++)
+      values[bit] = (row[bit / 64] >> (bit % 64)) & 1;
+
+    text.write(&values[0], &values[h.numInputs], &values[h.numInputs + h.numLatches]);
+  }
+
+  if(!text.close()){
+    error = text.error();
+    return false;
+  }
+
+  return true;
+}
+
+// '0' + value, eight at a time
+void AigOutput::put_text(const unsigned char* values, unsigned n){
+  unsigned i;
+  uint64_t word;
+  char* p = &buffer[used];
+
+  for(i = 0; i + sizeof(word) <= n; i += sizeof(word)){
+    memcpy(&word, values + i, sizeof(word));
+    word |= ASCII_ZEROS;
+    memcpy(p + i, &word, sizeof(word));
+  }
+  for(; i < n; i++)
+    p[i] = '0' + values[i];
+
+  used += n;
+}
+
+// ors the values into the row at used, starting at bit
+void AigOutput::put_bits(const unsigned char* values, unsigned n, unsigned &bit){
+  unsigned i;
+  uint64_t word;
+  char* row = &buffer[used];
+
+  for(i = 0; i < n; bit++, i++){
+    if(!values[i])
+      continue;
+
+    memcpy(&word, row + bit / 64 * sizeof(word), sizeof(word));
+    word |= (uint64_t) 1 << (bit % 64);
+    memcpy(row + bit / 64 * sizeof(word), &word, sizeof(word));
+  }
+}
+
+// partial writes are continued, the first error is kept
+void AigOutput::flush(void){
+  size_t done = 0;
+  ssize_t n;
+
+  if(memory){
+    memory->insert(memory->end(), buffer.begin(), buffer.begin() + used);
+    used = 0;
+    return;
+  }
+
+  while(done < used && !failed){
+    n = ::write(fd, &buffer[done], used - done);
+    if(n < 0 && errno == EINTR)
+      continue;
+
+    if(n <= 0){
+      failed = true;
+      message = "Unable to write output file";
+      break;
+    }
+    done += n;
+  }
+
+  used = 0;
+}
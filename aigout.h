@@ -0,0 +1,74 @@
+#ifndef AIGOUT_H
+#define AIGOUT_H
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include "aignode.h"
+
+#define OUTPUT_MAGIC "AIGSIMOU"
+#define OUTPUT_VERSION 1
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+
+// columns of a cycle
+#define COLUMN_INPUTS 1
+#define COLUMN_LATCHES 2
+#define COLUMN_OUTPUTS 4
+#define COLUMN_ALL 7
+
+// Start of a packed output file, the rows follow.
+struct AigOutputHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t columns;
+  uint32_t numInputs;
+  uint32_t numLatches;
+  uint32_t numOutputs;
+  uint32_t rowWords;
+  uint64_t numCycles;
+};
+
+// Sink for the simulated cycles.  Text lines hold the selected columns
+// separated by a space, packed rows their bits in the same order, in 64
+// bit words like packed traces.  Cycles are collected in a large buffer
+// that is only written when full or on close, to a file or to memory.
+class AigOutput {
+
+public:
+  AigOutput();
+  ~AigOutput();
+
+  bool open(const string &fileName, bool packed, unsigned columns, unsigned numInputs, unsigned numLatches, unsigned numOutputs);
+  void open(vector<char>* memory, bool packed, unsigned columns, unsigned numInputs, unsigned numLatches, unsigned numOutputs);
+  void write(const unsigned char* inputs, const unsigned char* latches, const unsigned char* outputs);
+  bool close(void);
+  const string& error(void) const;
+
+  static bool parseColumns(const char* str, unsigned &columns);
+  static bool isPacked(const string &fileName);
+  static bool unpack(const string &packedFile, const string &textFile, string &error);
+
+private:
+  int fd;
+  vector<char>* memory;
+  bool packed;
+  unsigned columns;
+  unsigned numInputs;
+  unsigned numLatches;
+  unsigned numOutputs;
+  unsigned rowBytes;
+  uint64_t numCycles;
+  bool failed;
+  string message;
+
+  vector<char> buffer;
+  size_t used;
+
+  void start(bool packed, unsigned columns, unsigned numInputs, unsigned numLatches, unsigned numOutputs);
+  void put_text(const unsigned char* values, unsigned n);
+  void put_bits(const unsigned char* values, unsigned n, unsigned &bit);
+  void flush(void);
+};
+
+#endif
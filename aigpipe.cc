@@ -0,0 +1,240 @@
+#include <cstring>
+#include <sched.h>
+#include "aigpipe.h"
+#include "aigsim.h"
+
+#define SPIN_LIMIT 64
+
+AigRing::AigRing(unsigned capacity)
+{
+  slots.resize(capacity);
+  head = 0;
+  tail = 0;
+  sleepers = 0;
+  pthread_mutex_init(&mutex, NULL);
+  pthread_cond_init(&moved, NULL);
+}
+
+AigRing::~AigRing()
+{
+  pthread_cond_destroy(&moved);
+  pthread_mutex_destroy(&mutex);
+}
+
+// Only the producer moves head and only the consumer tail.  The barrier
+// publishes the slot before the index and orders the index read before
+// the slot access.
+void AigRing::push(AigCycleBlock* block){
+  if(head - tail == slots.size())
+    wait(true);
+
+  slots[head % slots.size()] = block;
+  __sync_synchronize();
+  head++;
+  wake();
+}
+
+AigCycleBlock* AigRing::pop(void){
+  AigCycleBlock* block;
+
+  if(head == tail)
+    wait(false);
+
+  __sync_synchronize();
+  block = slots[tail % slots.size()];
+  __sync_synchronize();
+  tail++;
+  wake();
+
+  return block;
+}
+
+// Until the ring isn't full for the producer or empty for the consumer.
+// The sleeper counts itself before it checks again and the other side
+// moves its index before it reads the count, with barriers in between,
+// so one of them sees the other.  The mutex keeps the wake up from
+// coming between the check and the sleep.
+void AigRing::wait(bool producer){
+  unsigned spins = 0;
+
+  while(producer ? head - tail == slots.size() : head == tail){
+    if(++spins <= SPIN_LIMIT){
+      sched_yield();
+      continue;
+    }
+
+    pthread_mutex_lock(&mutex);
+    __sync_fetch_and_add(&sleepers, 1);
+    while(producer ? head - tail == slots.size() : head == tail)
+      pthread_cond_wait(&moved, &mutex);
+    __sync_fetch_and_sub(&sleepers, 1);
+    pthread_mutex_unlock(&mutex);
+  }
+}
+
+void AigRing::wake(void){
+  __sync_synchronize();
+  if(!sleepers)
+    return;
+
+  pthread_mutex_lock(&mutex);
+  pthread_cond_broadcast(&moved);
+  pthread_mutex_unlock(&mutex);
+}
+
+AigPipe::AigPipe(AigSim &sim, unsigned numInputs, unsigned numLatches, unsigned numOutputs, unsigned blockCycles)
+  : sim(sim), numInputs(numInputs), numLatches(numLatches), numOutputs(numOutputs), blockCycles(blockCycles),
+    unused(PIPE_BLOCKS), filled(PIPE_BLOCKS), simulated(PIPE_BLOCKS)
+{
+  unsigned i;
+
+  rowWords = (numInputs + 63) / 64;
+  text = NULL;
+  packed = NULL;
+  dst = NULL;
+  limit = 0;
+
+  // one more byte keeps the arrays non empty
+  blocks.resize(PIPE_BLOCKS);
+  for(i = 0; i < PIPE_BLOCKS; i++){
+    blocks[i].rows.resize((size_t) blockCycles * rowWords + 1);
+    blocks[i].in.resize((size_t) blockCycles * numInputs + 1);
+    blocks[i].state.resize((size_t) blockCycles * numLatches + 1);
+    blocks[i].out.resize((size_t) blockCycles * numOutputs + 1);
+    unused.push(&blocks[i]);
+  }
+}
+
+AigPipe::~AigPipe()
+{
+
+}
+
+// Simulates one of the traces into dst for at most limit cycles, the
+// calling thread is the simulator.
+bool AigPipe::run(AigTextTrace* text, const AigTrace* packed, AigOutput &dst, uint64_t limit, int &status, uint64_t &line, uint64_t &cycles){
+  pthread_t readerThread, writerThread;
+  AigCycleBlock* block;
+
+  this->text = text;
+  this->packed = packed;
+  this->dst = &dst;
+  this->limit = limit;
+
+  if(pthread_create(&writerThread, NULL, writer, this))
+    return false;
+
+  // nothing was read, stop the writer with an empty last block
+  if(pthread_create(&readerThread, NULL, reader, this)){
+    block = unused.pop();
+    block->cycles = 0;
+    block->status = 1;
+    simulated.push(block);
+    pthread_join(writerThread, NULL);
+    return false;
+  }
+
+  simulate_blocks(status, line, cycles);
+
+  pthread_join(readerThread, NULL);
+  pthread_join(writerThread, NULL);
+
+  return true;
+}
+
+void* AigPipe::reader(void* pipe){
+  ((AigPipe*) pipe)->read_blocks();
+  return NULL;
+}
+
+void* AigPipe::writer(void* pipe){
+  ((AigPipe*) pipe)->write_blocks();
+  return NULL;
+}
+
+void AigPipe::read_blocks(void){
+  AigCycleBlock* block;
+  const uint64_t* row;
+  uint64_t next = 0;
+  uint64_t taken = 0;
+  int status;
+
+  do{
+    block = unused.pop();
+    block->cycles = 0;
+    block->status = 0;
+    block->line = 0;
+
+    while(block->cycles < blockCycles){
+      if(limit && taken == limit){
+        block->status = 1;
+        break;
+      }
+
+      if(text){
+        status = text->next(row);
+        if(status <= 0){
+          block->status = status < 0 ? -1 : 1;
+          block->line = text->line();
+          break;
+        }
+      }
+      else{
+        if(next == packed->numCycles()){
+          block->status = 1;
+          break;
+        }
+        row = packed->row(next++);
+      }
+
+      memcpy(&block->rows[(size_t) block->cycles * rowWords], row, rowWords * sizeof(uint64_t));
+      block->cycles++;
+      taken++;
+    }
+
+    filled.push(block);
+  } while(!block->status);
+}
+
+void AigPipe::simulate_blocks(int &status, uint64_t &line, uint64_t &cycles){
+  AigCycleBlock* block;
+  const uint64_t* row;
+  unsigned char* in;
+  unsigned c, i;
+
+  do{
+    block = filled.pop();
+
+    for(c = 0; c < block->cycles; c++){
+      row = &block->rows[(size_t) c * rowWords];
+      in = &block->in[(size_t) c * numInputs];
+      for(i = 0; i < numInputs; i++)
+        in[i] = (row[i / 64] >> (i % 64)) & 1;
+
+      sim.step(in, &block->state[(size_t) c * numLatches], &block->out[(size_t) c * numOutputs]);
+    }
+
+    cycles += block->cycles;
+
+    // the block may be reused once pushed
+    status = block->status;
+    line = block->line;
+    simulated.push(block);
+  } while(!status);
+}
+
+void AigPipe::write_blocks(void){
+  AigCycleBlock* block;
+  unsigned c;
+  int status;
+
+  do{
+    block = simulated.pop();
+
+    for(c = 0; c < block->cycles; c++)
+      dst->write(&block->in[(size_t) c * numInputs], &block->state[(size_t) c * numLatches], &block->out[(size_t) c * numOutputs]);
+
+    status = block->status;
+    unused.push(block);
+  } while(!status);
+}
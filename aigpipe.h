@@ -0,0 +1,92 @@
+#ifndef AIGPIPE_H
+#define AIGPIPE_H
+
+#include <vector>
+#include <stdint.h>
+#include <pthread.h>
+#include "aigtrace.h"
+#include "aigout.h"
+
+#define PIPE_BLOCK_CYCLES 4096
+#define PIPE_BLOCKS 8
+
+class AigSim;
+
+// Cycles passed between the stages.  status is 0 while more blocks
+// follow, 1 on the last block and -1 if the trace has an invalid value
+// in line.
+struct AigCycleBlock
+{
+  unsigned cycles;
+  int status;
+  uint64_t line;
+  vector<uint64_t> rows;
+  vector<unsigned char> in;
+  vector<unsigned char> state;
+  vector<unsigned char> out;
+};
+
+// Single producer single consumer ring of blocks, the producer waits
+// while it is full and the consumer while it is empty.  A wait yields a
+// while, then sleeps until the other side moves its index.
+class AigRing {
+
+public:
+  AigRing(unsigned capacity);
+  ~AigRing();
+
+  void push(AigCycleBlock* block);
+  AigCycleBlock* pop(void);
+
+private:
+  vector<AigCycleBlock*> slots;
+  volatile unsigned head;
+  volatile unsigned tail;
+
+  // sides asleep on moved
+  volatile unsigned sleepers;
+  pthread_mutex_t mutex;
+  pthread_cond_t moved;
+
+  void wait(bool producer);
+  void wake(void);
+};
+
+// Reader, simulator and writer on their own threads.  Filled blocks go
+// from the reader to the simulator to the writer and back to the reader
+// empty, so at most PIPE_BLOCKS blocks are in flight.
+class AigPipe {
+
+public:
+  AigPipe(AigSim &sim, unsigned numInputs, unsigned numLatches, unsigned numOutputs, unsigned blockCycles);
+  ~AigPipe();
+
+  // status and line of the last block, false if the threads can't start
+  bool run(AigTextTrace* text, const AigTrace* packed, AigOutput &dst, uint64_t limit, int &status, uint64_t &line, uint64_t &cycles);
+
+private:
+  AigSim &sim;
+  unsigned numInputs;
+  unsigned numLatches;
+  unsigned numOutputs;
+  unsigned rowWords;
+  unsigned blockCycles;
+
+  vector<AigCycleBlock> blocks;
+  AigRing unused;
+  AigRing filled;
+  AigRing simulated;
+
+  AigTextTrace* text;
+  const AigTrace* packed;
+  AigOutput* dst;
+  uint64_t limit;
+
+  static void* reader(void* pipe);
+  static void* writer(void* pipe);
+  void read_blocks(void);
+  void simulate_blocks(int &status, uint64_t &line, uint64_t &cycles);
+  void write_blocks(void);
+};
+
+#endif
@@ -0,0 +1,139 @@
+#include <cstdio>
+#include <algorithm>
+#include "aigprof.h"
+
+// sorts roots by estimated time and ids by evaluations, descending
+struct ByTime
+{
+  const vector<double> &time;
+  ByTime(const vector<double> &time) : time(time) {}
+  bool operator()(unsigned a, unsigned b) const { return time[a] > time[b] || (time[a] == time[b] && a < b); }
+};
+
+struct ByCount
+{
+  const vector<uint64_t> &count;
+  ByCount(const vector<uint64_t> &count) : count(count) {}
+  bool operator()(unsigned a, unsigned b) const { return count[a] > count[b] || (count[a] == count[b] && a < b); }
+};
+
+AigProfile::AigProfile(AigDef &mgr, vector<AigNode*> &latches, vector<AigNode*> &outputs)
+  : mgr(mgr), latches(latches), outputs(outputs)
+{
+  Cone empty = { 0, 0, 0, 0 };
+
+  cycles = 0;
+  timed = false;
+  evaluations.assign(mgr.numNodeIds(), 0);
+  cones.assign(latches.size() + outputs.size(), empty);
+}
+
+AigProfile::~AigProfile()
+{
+
+}
+
+// starts a cycle, true if its cones are to be timed
+bool AigProfile::cycle(void){
+  timed = cycles++ % PROFILE_SAMPLE_CYCLES == 0;
+  return timed;
+}
+
+// one walk of the cone of root, seconds is ignored in untimed cycles
+void AigProfile::record(unsigned root, const vector<AigNode*> &traversedNodes, double seconds){
+  unsigned i;
+  Cone &cone = cones[root];
+
+  for(i = 0; i < traversedNodes.size(); i++)
+    evaluations[traversedNodes[i]->get_id()]++;
+
+  cone.walks++;
+  cone.ands += traversedNodes.size();
+  if(timed){
+    cone.samples++;
+    cone.seconds += seconds;
+  }
+}
+
+// mean of the timed walks times all walks
+double AigProfile::estimate(unsigned root) const{
+  const Cone &cone = cones[root];
+
+  return cone.samples ? cone.seconds / cone.samples * cone.walks : 0;
+}
+
+// aiger literal of an and, the inverter made for a complemented literal
+// is the complement of its fanin
+unsigned AigProfile::and_lit(AigNode* node) const{
+  if(node->get_lpol() && node->get_right() == mgr.One() && !node->get_rpol())
+    return 2 * node->get_left()->get_index() ^ 1;
+
+  return 2 * node->get_index();
+}
+
+// Cones ranked by estimated time, then ands by evaluations, with their
+// aiger literals.  Latch cones are named by the latch, outputs by their
+// position in the file and reported with its literal.  Ands added by
+// -O or -S have literals beyond the file's.
+void AigProfile::write(ostream &out, AigSymbols &syms, const vector<unsigned> &outputPositions, const vector<unsigned> &outputLits){
+  char buffer[160];
+  unsigned i, k, root, lit;
+  uint64_t total = 0;
+  double seconds = 0;
+  const char* name;
+  vector<double> time(cones.size());
+  vector<unsigned> order;
+
+  for(root = 0; root < cones.size(); root++){
+    time[root] = estimate(root);
+    seconds += time[root];
+    total += cones[root].ands;
+    order.push_back(root);
+  }
+  sort(order.begin(), order.end(), ByTime(time));
+
+  out << "profile: " << cycles << " cycles, " << (cycles + PROFILE_SAMPLE_CYCLES - 1) / PROFILE_SAMPLE_CYCLES << " timed, "
+      << total << " and evaluations, " << cones.size() << " cones" << endl << endl;
+
+  sprintf(buffer, "%4s  %-6s  %8s  %10s  %10s  %10s  %6s  %s", "rank", "cone", "lit", "ands/walk", "ns/walk", "est ms", "share", "name");
+  out << buffer << endl;
+
+  for(k = 0; k < order.size() && k < PROFILE_TOP; k++){
+    root = order[k];
+    if(root < latches.size()){
+      lit = 2 * latches[root]->get_index();
+      name = syms.litName(lit);
+    }
+    else if(root - latches.size() < outputPositions.size()){
+      lit = outputLits[outputPositions[root - latches.size()]];
+      name = syms.outputName(outputPositions[root - latches.size()]);
+    }
+    else{
+      lit = and_lit(outputs[root - latches.size()]);
+      name = NULL;
+    }
+
+    sprintf(buffer, "%4u  %-6s  %8u  %10.1f  %10.1f  %10.3f  %5.1f%%  %s", k + 1, root < latches.size() ? "latch" : "output", lit,
+            cones[root].walks ? (double) cones[root].ands / cones[root].walks : 0.0,
+            cones[root].samples ? cones[root].seconds / cones[root].samples * 1e9 : 0.0,
+            time[root] * 1e3, seconds > 0 ? 100 * time[root] / seconds : 0.0, name ? name : "-");
+    out << buffer << endl;
+  }
+
+  order.clear();
+  for(i = 0; i < evaluations.size(); i++)
+    if(evaluations[i])
+      order.push_back(i);
+  sort(order.begin(), order.end(), ByCount(evaluations));
+
+  out << endl;
+  sprintf(buffer, "%4s  %8s  %12s  %10s  %6s", "rank", "and lit", "evaluations", "per cycle", "share");
+  out << buffer << endl;
+
+  for(k = 0; k < order.size() && k < PROFILE_TOP; k++){
+    i = order[k];
+    sprintf(buffer, "%4u  %8u  %12llu  %10.2f  %5.1f%%", k + 1, and_lit(mgr.idNode(i)), (unsigned long long) evaluations[i],
+            cycles ? (double) evaluations[i] / cycles : 0.0, total ? 100.0 * evaluations[i] / total : 0.0);
+    out << buffer << endl;
+  }
+}
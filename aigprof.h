@@ -0,0 +1,55 @@
+#ifndef AIGPROF_H
+#define AIGPROF_H
+
+#include <vector>
+#include <ostream>
+#include <stdint.h>
+#include "aig.h"
+#include "aigsym.h"
+
+// cycles between those whose cones are timed
+#define PROFILE_SAMPLE_CYCLES 16
+// cones and ands listed in the report
+#define PROFILE_TOP 30
+
+// Evaluation counts of the ands and cones of the reference engine, which
+// walks the cone of each latch and output on its own every cycle.  A
+// shared and is evaluated once per cone it is in.  The cones of every
+// PROFILE_SAMPLE_CYCLES cycle are timed.  Needs the ids of buildFanout.
+class AigProfile {
+
+public:
+  AigProfile(AigDef &mgr, vector<AigNode*> &latches, vector<AigNode*> &outputs);
+  ~AigProfile();
+
+  bool cycle(void);
+  void record(unsigned root, const vector<AigNode*> &traversedNodes, double seconds);
+  void write(ostream &out, AigSymbols &syms, const vector<unsigned> &outputPositions, const vector<unsigned> &outputLits);
+
+private:
+  AigDef &mgr;
+  vector<AigNode*> &latches;
+  vector<AigNode*> &outputs;
+
+  uint64_t cycles;
+  bool timed;
+
+  // by id
+  vector<uint64_t> evaluations;
+
+  // by root, the latches then the outputs
+  struct Cone
+  {
+    uint64_t walks;
+    uint64_t ands;
+    uint64_t samples;
+    double seconds;
+  };
+
+  vector<Cone> cones;
+
+  double estimate(unsigned root) const;
+  unsigned and_lit(AigNode* node) const;
+};
+
+#endif
@@ -0,0 +1,369 @@
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "aigprog.h"
+
+#define HEADER_WORDS (sizeof(AigProgramHeader) / sizeof(uint32_t))
+#define FNV_OFFSET 14695981039346656037ULL
+#define FNV_PRIME 1099511628211ULL
+
+// literal of an and in id order to its slot in level order
+static inline uint32_t remap(unsigned lit, unsigned first, const vector<unsigned> &order){
+  if((lit >> 1) < first)
+    return lit;
+
+  return 2 * (first + order[(lit >> 1) - first]) + (lit & 1);
+}
+
+AigProgram::AigProgram()
+{
+  map = NULL;
+  mapSize = 0;
+  header = NULL;
+  arrays = NULL;
+}
+
+AigProgram::~AigProgram()
+{
+  release();
+}
+
+// Number the nodes, folding ands with a constant or repeated fanin into a
+// fanin literal, then sort the ands by level.  The ands the outputs depend
+// on are listed separately, they are evaluated again after the latches
+// are updated.
+void AigProgram::compile(AigDef &mgr, vector<AigNode*> &inputs, vector<AigNode*> &latches, vector<AigNode*> &latchLogic, vector<AigNode*> &outputs){
+  unsigned i, k, id, n, left, right, first, ands, levels, words, numCone;
+  AigNode* node;
+  AigProgramHeader* h;
+  uint32_t* p;
+  vector<unsigned> lits, rhs, level, start, order, faninOf;
+  vector<unsigned char> mark;
+
+  release();
+
+  mgr.buildFanout(inputs, latches, latchLogic, outputs);
+  n = mgr.numNodeIds();
+  first = inputs.size() + latches.size() + 1;
+
+  lits.assign(n, 0);
+  lits[mgr.Zero()->get_id()] = 0;
+  lits[mgr.One()->get_id()] = 1;
+
+  for(i = 0; i < inputs.size(); i++)
+    lits[inputs[i]->get_id()] = 2 * (i + 1);
+
+  for(i = 0; i < latches.size(); i++)
+    lits[latches[i]->get_id()] = 2 * (inputs.size() + i + 1);
+
+  for(id = 0; id < n; id++){
+    node = mgr.idNode(id);
+    if(!node->is_and())
+      continue;
+
+    left = lits[node->get_left()->get_id()] ^ node->get_lpol();
+    right = lits[node->get_right()->get_id()] ^ node->get_rpol();
+
+    if(left == 0 || right == 0 || left == (right ^ 1))
+      lits[id] = 0;
+    else if(left == 1 || left == right)
+      lits[id] = right;
+    else if(right == 1)
+      lits[id] = left;
+    else{
+      lits[id] = 2 * (first + rhs.size() / 2);
+      rhs.push_back(left);
+      rhs.push_back(right);
+    }
+  }
+
+  // inputs, latches and the constant are level 0
+  ands = rhs.size() / 2;
+  levels = 0;
+  level.assign(first + ands, 0);
+  for(k = 0; k < ands; k++){
+    left = level[rhs[2 * k] >> 1];
+    right = level[rhs[2 * k + 1] >> 1];
+    level[first + k] = (left > right ? left : right) + 1;
+    if(level[first + k] > levels)
+      levels = level[first + k];
+  }
+
+  start.assign(levels + 1, 0);
+  for(k = 0; k < ands; k++)
+    start[level[first + k]]++;
+  for(k = 1; k <= levels; k++)
+    start[k] += start[k - 1];
+
+  // start[l - 1] is the first and of level l, counting sort keeps id order
+  order.resize(ands);
+  for(k = 0; k < ands; k++)
+    order[k] = start[level[first + k] - 1]++;
+  for(k = levels; k > 0; k--)
+    start[k] = start[k - 1];
+  start[0] = 0;
+
+  mark.assign(ands, 0);
+  for(i = 0; i < outputs.size(); i++)
+    if((lits[outputs[i]->get_id()] >> 1) >= first)
+      mark[order[(lits[outputs[i]->get_id()] >> 1) - first]] = 1;
+
+  faninOf.resize(2 * ands);
+  for(k = 0; k < ands; k++){
+    faninOf[2 * order[k]] = remap(rhs[2 * k], first, order);
+    faninOf[2 * order[k] + 1] = remap(rhs[2 * k + 1], first, order);
+  }
+  vector<unsigned>().swap(rhs);
+
+  numCone = 0;
+  for(k = ands; k > 0; k--){
+    if(!mark[k - 1])
+      continue;
+
+    numCone++;
+    for(i = 0; i < 2; i++)
+      if((faninOf[2 * (k - 1) + i] >> 1) >= first)
+        mark[(faninOf[2 * (k - 1) + i] >> 1) - first] = 1;
+  }
+
+  words = inputs.size() + 2 * latches.size() + outputs.size() + 2 * ands + levels + 1 + numCone;
+  image.assign(HEADER_WORDS + words, 0);
+
+  h = (AigProgramHeader*) &image[0];
+  memcpy(h->magic, PROGRAM_MAGIC, sizeof(h->magic));
+  h->version = PROGRAM_VERSION;
+  h->words = words;
+  h->key = 0;
+  h->numInputs = inputs.size();
+  h->numLatches = latches.size();
+  h->numOutputs = outputs.size();
+  h->numAnds = ands;
+  h->numLevels = levels;
+  h->numCone = numCone;
+
+  p = &image[HEADER_WORDS];
+  for(i = 0; i < inputs.size(); i++)
+    *p++ = i + 1;
+  for(i = 0; i < latches.size(); i++)
+    *p++ = inputs.size() + i + 1;
+  for(i = 0; i < latchLogic.size(); i++)
+    *p++ = remap(lits[latchLogic[i]->get_id()], first, order);
+  for(i = 0; i < outputs.size(); i++)
+    *p++ = remap(lits[outputs[i]->get_id()], first, order);
+  for(k = 0; k < 2 * ands; k++)
+    *p++ = faninOf[k];
+  for(k = 0; k <= levels; k++)
+    *p++ = start[k];
+  for(k = 0; k < ands; k++)
+    if(mark[k])
+      *p++ = k;
+
+  h->checksum = checksum(&image[HEADER_WORDS], words);
+  attach(&image[0]);
+}
+
+// written next to the cache file and renamed, concurrent runs never see a
+// partial file
+bool AigProgram::save(const string &fileName, uint64_t key){
+  char suffix[32];
+  string tmpName;
+
+  if(image.empty())
+    return false;
+
+  ((AigProgramHeader*) &image[0])->key = key;
+
+  sprintf(suffix, ".%d", (int) getpid());
+  tmpName = fileName + suffix;
+
+  ofstream out(tmpName.c_str(), ios::out | ios::binary);
+  if(!out.is_open())
+    return false;
+
+  out.write((const char*) &image[0], image.size() * sizeof(uint32_t));
+  out.close();
+
+  if(out.fail() || rename(tmpName.c_str(), fileName.c_str())){
+    unlink(tmpName.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+// Maps a cache file read only.  False if it is missing, of another
+// version, built from another source or options, or damaged.
+bool AigProgram::load(const string &fileName, uint64_t key){
+  int fd;
+  struct stat st;
+  void* data;
+  const AigProgramHeader* h;
+  const uint32_t* words;
+
+  fd = open(fileName.c_str(), O_RDONLY);
+  if(fd < 0)
+    return false;
+
+  if(fstat(fd, &st) || (size_t) st.st_size < sizeof(AigProgramHeader) || st.st_size % sizeof(uint32_t)){
+    close(fd);
+    return false;
+  }
+
+  data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(data == MAP_FAILED)
+    return false;
+
+  h = (const AigProgramHeader*) data;
+  words = (const uint32_t*) data + HEADER_WORDS;
+
+  if(memcmp(h->magic, PROGRAM_MAGIC, sizeof(h->magic)) || h->version != PROGRAM_VERSION || h->key != key
+     || (size_t) st.st_size != (HEADER_WORDS + h->words) * sizeof(uint32_t)
+     || h->words != (uint64_t) h->numInputs + 2 * (uint64_t) h->numLatches + h->numOutputs + 2 * (uint64_t) h->numAnds + h->numLevels + 1 + h->numCone
+     || h->checksum != checksum(words, h->words)){
+    munmap(data, st.st_size);
+    return false;
+  }
+
+  release();
+  map = data;
+  mapSize = st.st_size;
+  attach(data);
+
+  return true;
+}
+
+// Hash of the source file contents and the options that shape the
+// program, zero if the file can't be read.
+uint64_t AigProgram::sourceKey(const string &fileName, const string &options){
+  int fd;
+  struct stat st;
+  const unsigned char* data;
+  uint64_t hash, word;
+  size_t i;
+
+  fd = open(fileName.c_str(), O_RDONLY);
+  if(fd < 0)
+    return 0;
+
+  if(fstat(fd, &st)){
+    close(fd);
+    return 0;
+  }
+
+  hash = FNV_OFFSET;
+  if(st.st_size){
+    data = (const unsigned char*) mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(data == MAP_FAILED){
+      close(fd);
+      return 0;
+    }
+
+    // eight bytes per step, the tail byte by byte
+    for(i = 0; i + sizeof(word) <= (size_t) st.st_size; i += sizeof(word)){
+      memcpy(&word, data + i, sizeof(word));
+      hash = (hash ^ word) * FNV_PRIME;
+    }
+    for(; i < (size_t) st.st_size; i++)
+      hash = (hash ^ data[i]) * FNV_PRIME;
+
+    munmap((void*) data, st.st_size);
+  }
+  close(fd);
+
+  for(i = 0; i < options.size(); i++)
+    hash = (hash ^ (unsigned char) options[i]) * FNV_PRIME;
+
+  return hash ? hash : 1;
+}
+
+unsigned AigProgram::numInputs(void) const{
+  return header->numInputs;
+}
+
+unsigned AigProgram::numLatches(void) const{
+  return header->numLatches;
+}
+
+unsigned AigProgram::numOutputs(void) const{
+  return header->numOutputs;
+}
+
+unsigned AigProgram::numAnds(void) const{
+  return header->numAnds;
+}
+
+unsigned AigProgram::numLevels(void) const{
+  return header->numLevels;
+}
+
+unsigned AigProgram::numCone(void) const{
+  return header->numCone;
+}
+
+unsigned AigProgram::numSlots(void) const{
+  return firstAnd() + header->numAnds;
+}
+
+unsigned AigProgram::firstAnd(void) const{
+  return header->numInputs + header->numLatches + 1;
+}
+
+const uint32_t* AigProgram::inputSlots(void) const{
+  return arrays;
+}
+
+const uint32_t* AigProgram::latchSlots(void) const{
+  return inputSlots() + header->numInputs;
+}
+
+const uint32_t* AigProgram::latchNext(void) const{
+  return latchSlots() + header->numLatches;
+}
+
+const uint32_t* AigProgram::outputLits(void) const{
+  return latchNext() + header->numLatches;
+}
+
+const uint32_t* AigProgram::fanins(void) const{
+  return outputLits() + header->numOutputs;
+}
+
+const uint32_t* AigProgram::levelStart(void) const{
+  return fanins() + 2 * header->numAnds;
+}
+
+const uint32_t* AigProgram::cone(void) const{
+  return levelStart() + header->numLevels + 1;
+}
+
+void AigProgram::release(void){
+  if(map)
+    munmap(map, mapSize);
+
+  map = NULL;
+  mapSize = 0;
+  header = NULL;
+  arrays = NULL;
+  vector<uint32_t>().swap(image);
+}
+
+void AigProgram::attach(const void* data){
+  header = (const AigProgramHeader*) data;
+  arrays = (const uint32_t*) data + HEADER_WORDS;
+}
+
+// FNV-1a over words
+uint64_t AigProgram::checksum(const uint32_t* words, size_t n){
+  uint64_t hash = FNV_OFFSET;
+  size_t i;
+
+  for(i = 0; i < n; i++)
+    hash = (hash ^ words[i]) * FNV_PRIME;
+
+  return hash;
+}
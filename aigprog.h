@@ -0,0 +1,77 @@
+#ifndef AIGPROG_H
+#define AIGPROG_H
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include "aig.h"
+
+#define PROGRAM_MAGIC "AIGPROG"
+#define PROGRAM_VERSION 1
+
+// Start of a program image.  The arrays follow as 32 bit words: input
+// slots, latch slots, latch next state literals, output literals, and
+// fanins, levelStart, the ands the outputs depend on.
+struct AigProgramHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t words;
+  uint64_t key;
+  uint64_t checksum;
+  uint32_t numInputs;
+  uint32_t numLatches;
+  uint32_t numOutputs;
+  uint32_t numAnds;
+  uint32_t numLevels;
+  uint32_t numCone;
+};
+
+// Simulation program of an aig.  Slot 0 is the constant, then inputs,
+// latches and the ands sorted by level.  Literals are 2 * slot + complement
+// and and k has slot firstAnd() + k.  The image is one block, either built
+// by compile() or mapped read only from a cache file by load().
+class AigProgram {
+
+public:
+  AigProgram();
+  ~AigProgram();
+
+  void compile(AigDef &mgr, vector<AigNode*> &inputs, vector<AigNode*> &latches, vector<AigNode*> &latchLogic, vector<AigNode*> &outputs);
+  bool save(const string &fileName, uint64_t key);
+  bool load(const string &fileName, uint64_t key);
+  static uint64_t sourceKey(const string &fileName, const string &options);
+
+  unsigned numInputs(void) const;
+  unsigned numLatches(void) const;
+  unsigned numOutputs(void) const;
+  unsigned numAnds(void) const;
+  unsigned numLevels(void) const;
+  unsigned numCone(void) const;
+  unsigned numSlots(void) const;
+  unsigned firstAnd(void) const;
+
+  const uint32_t* inputSlots(void) const;
+  const uint32_t* latchSlots(void) const;
+  const uint32_t* latchNext(void) const;
+  const uint32_t* outputLits(void) const;
+  // two fanin literals per and
+  const uint32_t* fanins(void) const;
+  // first and of each level, numLevels() + 1 entries
+  const uint32_t* levelStart(void) const;
+  // ands in the cone of the outputs, in level order
+  const uint32_t* cone(void) const;
+
+private:
+  vector<uint32_t> image;
+  void* map;
+  size_t mapSize;
+  const AigProgramHeader* header;
+  const uint32_t* arrays;
+
+  void release(void);
+  void attach(const void* data);
+  static uint64_t checksum(const uint32_t* words, size_t n);
+};
+
+#endif
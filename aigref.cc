@@ -0,0 +1,80 @@
+#include <ctime>
+#include "aigref.h"
+
+static double now(void){
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+AigRefSim::AigRefSim(AigDef &mgr, vector<AigNode*> &inputs, vector<AigNode*> &latches, vector<AigNode*> &latchLogic, vector<AigNode*> &outputs)
+  : mgr(mgr), inputs(inputs), latches(latches), latchLogic(latchLogic), outputs(outputs)
+{
+  profile = NULL;
+  timed = false;
+  reset();
+}
+
+AigRefSim::~AigRefSim()
+{
+
+}
+
+void AigRefSim::reset(void){
+  unsigned i;
+
+  terminalValues.clear();
+  for(i = 0; i < latches.size(); i++)
+    terminalValues[latches[i]->get_index()] = false;
+
+  next.assign(latches.size(), 0);
+  evaluated = 0;
+}
+
+// latches are read before and outputs after the update, as in AigSim
+void AigRefSim::step(const unsigned char* inputs, unsigned char* state, unsigned char* outputs){
+  unsigned i;
+
+  timed = profile && profile->cycle();
+
+  for(i = 0; i < this->inputs.size(); i++)
+    terminalValues[this->inputs[i]->get_index()] = inputs[i];
+
+  for(i = 0; i < latches.size(); i++){
+    state[i] = terminalValues[latches[i]->get_index()];
+    next[i] = eval(latchLogic[i], i) ^ latches[i]->get_rpol();
+  }
+
+  for(i = 0; i < latches.size(); i++)
+    terminalValues[latches[i]->get_index()] = next[i];
+
+  for(i = 0; i < this->outputs.size(); i++)
+    outputs[i] = eval(this->outputs[i], latches.size() + i);
+}
+
+uint64_t AigRefSim::evaluations(void) const{
+  return evaluated;
+}
+
+void AigRefSim::setProfile(AigProfile* profile){
+  this->profile = profile;
+}
+
+// The marks recursiveSim leaves are cleared for the next root.  Roots are
+// numbered latches first for the profile.
+bool AigRefSim::eval(AigNode* node, unsigned root){
+  unsigned i;
+  double start = timed ? now() : 0;
+  bool value = mgr.recursiveSim(node, terminalValues, traversedNodes);
+
+  if(profile)
+    profile->record(root, traversedNodes, timed ? now() - start : 0);
+
+  evaluated += traversedNodes.size();
+  for(i = 0; i < traversedNodes.size(); i++)
+    traversedNodes[i]->set_dependence(NOTSET);
+  traversedNodes.clear();
+
+  return value;
+}
@@ -0,0 +1,42 @@
+#ifndef AIGREF_H
+#define AIGREF_H
+
+#include <vector>
+#include <stdint.h>
+#include "aig.h"
+#include "aigprof.h"
+
+// The reference engine.  Next states and outputs are evaluated from the
+// nodes by recursiveSim each cycle, same values as AigSim on the program
+// compiled from them.
+class AigRefSim {
+
+public:
+  AigRefSim(AigDef &mgr, vector<AigNode*> &inputs, vector<AigNode*> &latches, vector<AigNode*> &latchLogic, vector<AigNode*> &outputs);
+  ~AigRefSim();
+
+  void reset(void);
+  void step(const unsigned char* inputs, unsigned char* state, unsigned char* outputs);
+  // ands evaluated since reset
+  uint64_t evaluations(void) const;
+  // counts every cone walk into profile, NULL stops
+  void setProfile(AigProfile* profile);
+
+private:
+  AigDef &mgr;
+  vector<AigNode*> &inputs;
+  vector<AigNode*> &latches;
+  vector<AigNode*> &latchLogic;
+  vector<AigNode*> &outputs;
+
+  valMap terminalValues;
+  vector<AigNode*> traversedNodes;
+  vector<unsigned char> next;
+  uint64_t evaluated;
+  AigProfile* profile;
+  bool timed;
+
+  bool eval(AigNode* node, unsigned root);
+};
+
+#endif
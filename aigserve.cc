@@ -0,0 +1,419 @@
+#include <new>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "aigserve.h"
+#include "aigsim.h"
+
+AigServer::AigServer()
+{
+  listenFd = -1;
+  stopping = false;
+  pthread_mutex_init(&lock, NULL);
+  pthread_cond_init(&ready, NULL);
+}
+
+AigServer::~AigServer()
+{
+  pthread_mutex_destroy(&lock);
+  pthread_cond_destroy(&ready);
+}
+
+// jobs name the design, the program is not copied
+void AigServer::addDesign(const string &name, const AigProgram* program){
+  names.push_back(name);
+  programs.push_back(program);
+}
+
+const string& AigServer::error(void) const{
+  return message;
+}
+
+// Accepts connections until a stop job, false with error() set if the
+// socket can't be set up.
+bool AigServer::serve(const string &socketPath, unsigned numWorkers){
+  struct sockaddr_un addr;
+  struct timeval timeout;
+  vector<pthread_t> threads;
+  pthread_t thread;
+  unsigned i;
+  int fd;
+
+  if(socketPath.size() >= sizeof(addr.sun_path)){
+    message = "Socket path too long " + socketPath;
+    return false;
+  }
+
+  // clients that go away must not end the server
+  signal(SIGPIPE, SIG_IGN);
+
+  listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(listenFd < 0){
+    message = "Unable to create socket";
+    return false;
+  }
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, socketPath.c_str());
+  unlink(socketPath.c_str());
+
+  if(bind(listenFd, (struct sockaddr*) &addr, sizeof(addr)) || listen(listenFd, SERVE_BACKLOG)){
+    close(listenFd);
+    message = "Unable to listen on " + socketPath;
+    return false;
+  }
+
+  for(i = 0; i < numWorkers; i++)
+    if(!pthread_create(&thread, NULL, worker, this))
+      threads.push_back(thread);
+
+  // reads time out to see a stop, a client may keep its connection
+  timeout.tv_sec = SERVE_POLL_SECONDS;
+  timeout.tv_usec = 0;
+
+  // without workers jobs are handled here, one connection at a time
+  while(!stopping){
+    fd = accept(listenFd, NULL, NULL);
+    if(fd < 0){
+      if(errno == EINTR || errno == ECONNABORTED)
+        continue;
+      break;
+    }
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    // an idle connection is dropped when another client waits
+    if(threads.empty()){
+      while(!stopping && (!idle(fd) || !idle(listenFd, 0)) && handle(fd))
+        ;
+      close(fd);
+      continue;
+    }
+
+    pthread_mutex_lock(&lock);
+    connections.push_back(fd);
+    pthread_cond_signal(&ready);
+    pthread_mutex_unlock(&lock);
+  }
+
+  // one end marker per worker
+  pthread_mutex_lock(&lock);
+  stopping = true;
+  for(i = 0; i < threads.size(); i++)
+    connections.push_back(-1);
+  pthread_cond_broadcast(&ready);
+  pthread_mutex_unlock(&lock);
+
+  for(i = 0; i < threads.size(); i++)
+    pthread_join(threads[i], NULL);
+
+  close(listenFd);
+  listenFd = -1;
+  unlink(socketPath.c_str());
+
+  return true;
+}
+
+void* AigServer::worker(void* server){
+  ((AigServer*) server)->work();
+  return NULL;
+}
+
+void AigServer::work(void){
+  int fd;
+
+  while(true){
+    pthread_mutex_lock(&lock);
+    while(connections.empty())
+      pthread_cond_wait(&ready, &lock);
+    fd = connections.front();
+    connections.pop_front();
+    pthread_mutex_unlock(&lock);
+
+    if(fd < 0)
+      return;
+
+    // an idle connection goes to the back of the queue while others wait
+    while(!stopping){
+      if(idle(fd)){
+        pthread_mutex_lock(&lock);
+        if(!connections.empty() && !stopping){
+          connections.push_back(fd);
+          fd = -1;
+        }
+        pthread_mutex_unlock(&lock);
+        if(fd < 0)
+          break;
+      }
+      else if(!handle(fd))
+        break;
+    }
+    if(fd >= 0)
+      close(fd);
+  }
+}
+
+// True when nothing arrives on fd for seconds.
+bool AigServer::idle(int fd, int seconds){
+  struct pollfd p;
+
+  p.fd = fd;
+  p.events = POLLIN;
+  p.revents = 0;
+
+  while(poll(&p, 1, seconds * 1000) < 0)
+    if(errno != EINTR)
+      return false;
+
+  return !p.revents;
+}
+
+// Runs one job of the connection, false when it ends or breaks the
+// protocol.  Failed jobs are reported in the reply.  A job that runs out
+// of memory fails alone, its connection is closed.
+bool AigServer::handle(int fd){
+  AigJobHeader job;
+  AigReplyHeader reply;
+  AigTrace packed;
+  AigTextTrace text;
+  AigOutput dst;
+  const AigProgram* program;
+  string design, trace, output, error;
+  vector<uint64_t> stimulus;
+  vector<char> result;
+  uint64_t cycles = 0;
+  bool ok = true;
+  bool keep;
+
+  if(!read_full(fd, &job, sizeof(job), &stopping) || job.magic != SERVE_MAGIC || job.stimulusSize > SERVE_MAX_STIMULUS)
+    return false;
+
+  if(!read_string(fd, job.designSize, design, &stopping) || !read_string(fd, job.traceSize, trace, &stopping) || !read_string(fd, job.outputSize, output, &stopping))
+    return false;
+
+  program = find(design);
+
+  // the rest of a rejected stimulus isn't read, the connection ends
+  keep = !job.stimulusSize;
+
+  try{
+    if(job.kind == JOB_STOP && !job.stimulusSize)
+      stop();
+    else if(job.kind != JOB_SIMULATE){
+      ok = false;
+      error = "Unknown job kind";
+    }
+    else if(!program){
+      ok = false;
+      error = "Unknown design " + design;
+    }
+    else if(job.stimulusSize && !(keep = read_stimulus(fd, job.stimulusSize, program, stimulus, error)))
+      ok = false;
+    else{
+      AigSim sim(*program);
+
+      if(job.stimulusSize){
+        ok = packed.attach(&stimulus[0], job.stimulusSize);
+        error = packed.error();
+      }
+      else
+        ok = sim.openTrace(trace, text, packed, error);
+
+      if(ok && !output.empty()){
+        ok = dst.open(output, job.flags & JOB_PACKED_OUTPUT, job.columns, program->numInputs(), program->numLatches(), program->numOutputs());
+        error = dst.error();
+      }
+      else if(ok)
+        dst.open(&result, job.flags & JOB_PACKED_OUTPUT, job.columns, program->numInputs(), program->numLatches(), program->numOutputs());
+
+      if(ok)
+        ok = sim.simulate(packed.isOpen() ? NULL : &text, &packed, dst, job.cycleLimit, 0, cycles, error);
+
+      if(!dst.close() && ok){
+        ok = false;
+        error = dst.error();
+      }
+    }
+  }
+  catch(bad_alloc&){
+    dst.close();
+    vector<char>().swap(result);
+    ok = false;
+    keep = false;
+    error = "Out of memory";
+  }
+
+  if(ok)
+    error.clear();
+
+  reply.magic = SERVE_MAGIC;
+  reply.status = ok ? 0 : 1;
+  reply.cycles = cycles;
+  reply.messageSize = error.size();
+  reply.outputSize = result.size();
+
+  return write_full(fd, &reply, sizeof(reply)) && write_full(fd, error.data(), error.size())
+    && (result.empty() || write_full(fd, &result[0], result.size())) && job.kind != JOB_STOP && keep;
+}
+
+// Reads an inline packed trace for program.  The header is checked
+// against the design and size before the rows are read, and memory only
+// grows with the rows that arrive.  False with error set if it doesn't
+// fit or the connection ends.
+bool AigServer::read_stimulus(int fd, uint64_t size, const AigProgram* program, vector<uint64_t> &stimulus, string &error){
+  AigTraceHeader h;
+  uint64_t rowBytes, done, chunk;
+  char buffer[128];
+
+  if(size < sizeof(h) || !read_full(fd, &h, sizeof(h), &stopping)){
+    error = "Invalid packed trace";
+    return false;
+  }
+
+  rowBytes = (uint64_t) ((h.numInputs + 63) / 64) * sizeof(uint64_t);
+  if(memcmp(h.magic, TRACE_MAGIC, sizeof(h.magic)) || h.version != TRACE_VERSION
+     || (rowBytes && h.numCycles > (size - sizeof(h)) / rowBytes)
+     || size != sizeof(h) + h.numCycles * rowBytes){
+    error = "Invalid packed trace";
+    return false;
+  }
+
+  if(h.numInputs != program->numInputs()){
+    sprintf(buffer, "Trace has %u inputs, the aig %u", h.numInputs, program->numInputs());
+    error = buffer;
+    return false;
+  }
+
+  // rows are whole words, one more keeps the array non empty
+  stimulus.resize(sizeof(h) / sizeof(uint64_t) + 1);
+  memcpy(&stimulus[0], &h, sizeof(h));
+
+  for(done = sizeof(h); done < size; done += chunk){
+    chunk = size - done < SERVE_STIMULUS_CHUNK ? size - done : SERVE_STIMULUS_CHUNK;
+    stimulus.resize((done + chunk) / sizeof(uint64_t) + 1);
+    if(!read_full(fd, (char*) &stimulus[0] + done, chunk, &stopping)){
+      error = "Lost connection";
+      return false;
+    }
+  }
+
+  return true;
+}
+
+const AigProgram* AigServer::find(const string &name) const{
+  unsigned i;
+
+  for(i = 0; i < names.size(); i++)
+    if(names[i] == name)
+      return programs[i];
+
+  return NULL;
+}
+
+// wakes up accept, the main loop then ends the workers
+void AigServer::stop(void){
+  stopping = true;
+  shutdown(listenFd, SHUT_RDWR);
+}
+
+// Sends one job and waits for its reply, false with error set if the
+// server can't be reached.
+bool AigServer::request(const string &socketPath, const AigJobHeader &job, const string &design, const string &trace, const string &output, const vector<uint64_t> &stimulus, AigReplyHeader &reply, string &message, vector<char> &result, string &error){
+  struct sockaddr_un addr;
+  AigJobHeader header = job;
+  int fd;
+  bool ok;
+
+  if(socketPath.size() >= sizeof(addr.sun_path)){
+    error = "Socket path too long " + socketPath;
+    return false;
+  }
+
+  fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  strcpy(addr.sun_path, socketPath.c_str());
+
+  if(fd < 0 || connect(fd, (struct sockaddr*) &addr, sizeof(addr))){
+    if(fd >= 0)
+      close(fd);
+    error = "Unable to connect to " + socketPath;
+    return false;
+  }
+
+  signal(SIGPIPE, SIG_IGN);
+
+  header.magic = SERVE_MAGIC;
+  header.designSize = design.size();
+  header.traceSize = trace.size();
+  header.outputSize = output.size();
+  header.reserved = 0;
+
+  ok = write_full(fd, &header, sizeof(header)) && write_full(fd, design.data(), design.size())
+    && write_full(fd, trace.data(), trace.size()) && write_full(fd, output.data(), output.size())
+    && (!header.stimulusSize || write_full(fd, &stimulus[0], header.stimulusSize))
+    && read_full(fd, &reply, sizeof(reply)) && reply.magic == SERVE_MAGIC
+    && read_string(fd, reply.messageSize, message);
+
+  if(ok){
+    result.resize(reply.outputSize);
+    ok = !reply.outputSize || read_full(fd, &result[0], reply.outputSize);
+  }
+  close(fd);
+
+  if(!ok)
+    error = "Lost connection to " + socketPath;
+
+  return ok;
+}
+
+// a read that times out is retried unless stop is set
+bool AigServer::read_full(int fd, void* data, size_t size, const volatile bool* stop){
+  ssize_t n;
+
+  while(size){
+    n = read(fd, data, size);
+    if(n < 0 && errno == EINTR)
+      continue;
+    if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && !(stop && *stop))
+      continue;
+    if(n <= 0)
+      return false;
+
+    data = (char*) data + n;
+    size -= n;
+  }
+
+  return true;
+}
+
+bool AigServer::write_full(int fd, const void* data, size_t size){
+  ssize_t n;
+
+  while(size){
+    n = write(fd, data, size);
+    if(n < 0 && errno == EINTR)
+      continue;
+    if(n <= 0)
+      return false;
+
+    data = (const char*) data + n;
+    size -= n;
+  }
+
+  return true;
+}
+
+bool AigServer::read_string(int fd, uint32_t size, string &str, const volatile bool* stop){
+  if(size > SERVE_MAX_NAME)
+    return false;
+
+  str.resize(size);
+  return !size || read_full(fd, &str[0], size, stop);
+}
@@ -0,0 +1,95 @@
+#ifndef AIGSERVE_H
+#define AIGSERVE_H
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <stdint.h>
+#include <pthread.h>
+#include "aigprog.h"
+#include "aigtrace.h"
+
+#define SERVE_MAGIC 0x4a474941u
+#define SERVE_BACKLOG 64
+#define SERVE_MAX_NAME 4096
+#define SERVE_MAX_STIMULUS ((uint64_t) 1 << 34)
+// inline stimulus is read this many bytes at a time
+#define SERVE_STIMULUS_CHUNK (1 << 20)
+// idle connections check for a stop this often
+#define SERVE_POLL_SECONDS 1
+
+// job kinds
+#define JOB_SIMULATE 1
+#define JOB_STOP 2
+
+// job flags
+#define JOB_PACKED_OUTPUT 1
+
+// Job request, followed by the design name, the trace path, the output
+// path and an inline packed trace.  Without stimulus the trace path is
+// read, without output path the output comes back in the reply.
+struct AigJobHeader
+{
+  uint32_t magic;
+  uint32_t kind;
+  uint32_t flags;
+  uint32_t columns;
+  uint64_t cycleLimit;
+  uint32_t designSize;
+  uint32_t traceSize;
+  uint32_t outputSize;
+  uint32_t reserved;
+  uint64_t stimulusSize;
+};
+
+// Reply, followed by the error message and the output.  status is 0 if
+// the job succeeded.
+struct AigReplyHeader
+{
+  uint32_t magic;
+  int32_t status;
+  uint64_t cycles;
+  uint64_t messageSize;
+  uint64_t outputSize;
+};
+
+// Simulation daemon.  Designs are compiled once and stay resident, jobs
+// arrive over a Unix domain socket and run on a pool of workers, one
+// connection at a time each.  A connection may send any number of jobs.
+class AigServer {
+
+public:
+  AigServer();
+  ~AigServer();
+
+  void addDesign(const string &name, const AigProgram* program);
+  bool serve(const string &socketPath, unsigned numWorkers);
+  const string& error(void) const;
+
+  static bool request(const string &socketPath, const AigJobHeader &job, const string &design, const string &trace, const string &output, const vector<uint64_t> &stimulus, AigReplyHeader &reply, string &message, vector<char> &result, string &error);
+
+private:
+  vector<string> names;
+  vector<const AigProgram*> programs;
+  string message;
+
+  int listenFd;
+  volatile bool stopping;
+  pthread_mutex_t lock;
+  pthread_cond_t ready;
+  deque<int> connections;
+
+  static void* worker(void* server);
+  void work(void);
+  bool handle(int fd);
+  static bool idle(int fd, int seconds = SERVE_POLL_SECONDS);
+  bool read_stimulus(int fd, uint64_t size, const AigProgram* program, vector<uint64_t> &stimulus, string &error);
+  const AigProgram* find(const string &name) const;
+  void stop(void);
+
+  static bool read_full(int fd, void* data, size_t size, const volatile bool* stop = NULL);
+  static bool write_full(int fd, const void* data, size_t size);
+  static bool read_string(int fd, uint32_t size, string &str, const volatile bool* stop = NULL);
+};
+
+#endif
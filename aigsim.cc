@@ -0,0 +1,267 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdio>
+#include "aigsim.h"
+
+AigSim::AigSim(const AigProgram &program)
+  : program(program)
+{
+  reset();
+}
+
+AigSim::~AigSim()
+{
+
+}
+
+void AigSim::reset(void){
+  values.assign(program.numSlots(), 0);
+  next.assign(program.numLatches(), 0);
+}
+
+// One cycle: state gets the latch values the inputs see, the latches are
+// updated and outputs are taken with the new latch values.  Only the ands
+// the outputs depend on are evaluated twice.
+void AigSim::step(const unsigned char* inputs, unsigned char* state, unsigned char* outputs){
+  unsigned i, k, lit0, lit1, ands, numCone;
+  unsigned char* v = &values[0];
+  const uint32_t* slots;
+  const uint32_t* fanins = program.fanins();
+  const uint32_t* cone = program.cone();
+  unsigned first = program.firstAnd();
+
+  slots = program.inputSlots();
+  for(i = 0; i < program.numInputs(); i++)
+    v[slots[i]] = inputs[i];
+
+  ands = program.numAnds();
+  for(k = 0; k < ands; k++){
+    lit0 = fanins[2 * k];
+    lit1 = fanins[2 * k + 1];
+    v[first + k] = (v[lit0 >> 1] ^ (lit0 & 1)) & (v[lit1 >> 1] ^ (lit1 & 1));
+  }
+
+  slots = program.latchSlots();
+  for(i = 0; i < program.numLatches(); i++){
+    state[i] = v[slots[i]];
+    next[i] = lit_value(program.latchNext()[i]);
+  }
+
+  for(i = 0; i < program.numLatches(); i++)
+    v[slots[i]] = next[i];
+
+  numCone = program.numCone();
+  for(i = 0; i < numCone; i++){
+    k = cone[i];
+    lit0 = fanins[2 * k];
+    lit1 = fanins[2 * k + 1];
+    v[first + k] = (v[lit0 >> 1] ^ (lit0 & 1)) & (v[lit1 >> 1] ^ (lit1 & 1));
+  }
+
+  for(i = 0; i < program.numOutputs(); i++)
+    outputs[i] = lit_value(program.outputLits()[i]);
+}
+
+// current latch values, those the next step's inputs see
+void AigSim::latchValues(unsigned char* state) const{
+  unsigned i;
+  const uint32_t* slots = program.latchSlots();
+
+  for(i = 0; i < program.numLatches(); i++)
+    state[i] = values[slots[i]];
+}
+
+// Simulates a text or packed trace file into dst, errors end the
+// program.  Returns the cycles simulated.
+uint64_t AigSim::run(string inputFile, string outputFile, bool packedOutput, unsigned columns, unsigned blockCycles){
+  AigTrace trace;
+  AigTextTrace text;
+  AigOutput dst;
+  uint64_t cycles;
+  string error;
+
+  if(!openTrace(inputFile, text, trace, error)){
+    cerr << error << endl;
+    exit(1);
+  }
+
+  if(!dst.open(outputFile, packedOutput, columns, program.numInputs(), program.numLatches(), program.numOutputs())){
+    cerr << dst.error() << endl;
+    exit(1);
+  }
+
+  if(!simulate(trace.isOpen() ? NULL : &text, &trace, dst, 0, blockCycles, cycles, error)){
+    cerr << error << endl;
+    dst.close();
+    exit(1);
+  }
+
+  if(!dst.close()){
+    cerr << dst.error() << endl;
+    exit(1);
+  }
+
+  return cycles;
+}
+
+// packed traces are recognized by their magic
+bool AigSim::openTrace(const string &fileName, AigTextTrace &text, AigTrace &packed, string &error){
+  if(AigTrace::isPacked(fileName)){
+    if(!packed.open(fileName)){
+      error = packed.error();
+      return false;
+    }
+  }
+  else if(!text.open(fileName, program.numInputs())){
+    error = "Unable to open file " + fileName;
+    return false;
+  }
+
+  return true;
+}
+
+// Simulates the text trace, or the packed one if text is NULL, from reset
+// for at most limit cycles, 0 is no limit.  Each cycle writes the selected
+// columns of inputs, latch values and outputs to dst.  With blockCycles
+// reading, simulating and writing overlap on three threads that pass
+// blocks of that many cycles.  False with error set if the trace doesn't
+// fit the program.
+bool AigSim::simulate(AigTextTrace* text, const AigTrace* packed, AigOutput &dst, uint64_t limit, unsigned blockCycles, uint64_t &cycles, string &error){
+  char buffer[128];
+  int status = 1;
+  uint64_t line = 0;
+
+  if(!text && packed->numInputs() != program.numInputs()){
+    sprintf(buffer, "Trace has %u inputs, the aig %u", packed->numInputs(), program.numInputs());
+    error = buffer;
+    return false;
+  }
+
+  in.resize(program.numInputs() + 1);
+  state.resize(program.numLatches() + 1);
+  out.resize(program.numOutputs() + 1);
+  reset();
+  cycles = 0;
+
+  // the pipeline falls back to one thread if it can't start
+  AigPipe pipe(*this, program.numInputs(), program.numLatches(), program.numOutputs(), blockCycles);
+  if(!blockCycles || !pipe.run(text, packed, dst, limit, status, line, cycles)){
+    if(text)
+      status = run_text(*text, dst, limit, line, cycles);
+    else
+      run_packed(*packed, dst, limit, cycles);
+  }
+
+  if(status < 0){
+    sprintf(buffer, "Invalid input value on line %llu", (unsigned long long) line);
+    error = buffer;
+    return false;
+  }
+
+  return true;
+}
+
+// -1 with the line of an invalid value
+int AigSim::run_text(AigTextTrace &trace, AigOutput &dst, uint64_t limit, uint64_t &line, uint64_t &cycles){
+  const uint64_t* row;
+  int status = 1;
+
+  while((!limit || cycles < limit) && (status = trace.next(row)) > 0){
+    unpack_row(row);
+    step(&in[0], &state[0], &out[0]);
+    dst.write(&in[0], &state[0], &out[0]);
+    cycles++;
+  }
+
+  line = trace.line();
+  return status;
+}
+
+// rows are used in place, only unpacked to bytes
+void AigSim::run_packed(const AigTrace &trace, AigOutput &dst, uint64_t limit, uint64_t &cycles){
+  for(; cycles < trace.numCycles() && (!limit || cycles < limit); cycles++){
+    unpack_row(trace.row(cycles));
+    step(&in[0], &state[0], &out[0]);
+    dst.write(&in[0], &state[0], &out[0]);
+  }
+}
+
+void AigSim::unpack_row(const uint64_t* row){
+  unsigned i;
+
+  for(i = 0; i < program.numInputs(); i++)
+    in[i] = (row[i / 64] >> (i % 64)) & 1;
+}
+
+unsigned char AigSim::lit_value(unsigned lit) const{
+  return values[lit >> 1] ^ (lit & 1);
+}
+
+AigLaneSim::AigLaneSim(const AigProgram &program)
+  : program(program)
+{
+  reset();
+}
+
+AigLaneSim::~AigLaneSim()
+{
+
+}
+
+void AigLaneSim::reset(void){
+  values.assign(program.numSlots(), 0);
+  next.assign(program.numLatches(), 0);
+}
+
+// complements are xors with all ones
+void AigLaneSim::step(const uint64_t* inputs, uint64_t* state, uint64_t* outputs){
+  unsigned i, k, lit0, lit1, ands, numCone;
+  uint64_t* v = &values[0];
+  const uint32_t* slots;
+  const uint32_t* fanins = program.fanins();
+  const uint32_t* cone = program.cone();
+  unsigned first = program.firstAnd();
+
+  slots = program.inputSlots();
+  for(i = 0; i < program.numInputs(); i++)
+    v[slots[i]] = inputs[i];
+
+  ands = program.numAnds();
+  for(k = 0; k < ands; k++){
+    lit0 = fanins[2 * k];
+    lit1 = fanins[2 * k + 1];
+    v[first + k] = (v[lit0 >> 1] ^ -(uint64_t) (lit0 & 1)) & (v[lit1 >> 1] ^ -(uint64_t) (lit1 & 1));
+  }
+
+  slots = program.latchSlots();
+  for(i = 0; i < program.numLatches(); i++){
+    state[i] = v[slots[i]];
+    next[i] = lit_value(program.latchNext()[i]);
+  }
+
+  for(i = 0; i < program.numLatches(); i++)
+    v[slots[i]] = next[i];
+
+  numCone = program.numCone();
+  for(i = 0; i < numCone; i++){
+    k = cone[i];
+    lit0 = fanins[2 * k];
+    lit1 = fanins[2 * k + 1];
+    v[first + k] = (v[lit0 >> 1] ^ -(uint64_t) (lit0 & 1)) & (v[lit1 >> 1] ^ -(uint64_t) (lit1 & 1));
+  }
+
+  for(i = 0; i < program.numOutputs(); i++)
+    outputs[i] = lit_value(program.outputLits()[i]);
+}
+
+void AigLaneSim::latchValues(uint64_t* state) const{
+  unsigned i;
+  const uint32_t* slots = program.latchSlots();
+
+  for(i = 0; i < program.numLatches(); i++)
+    state[i] = values[slots[i]];
+}
+
+uint64_t AigLaneSim::lit_value(unsigned lit) const{
+  return values[lit >> 1] ^ -(uint64_t) (lit & 1);
+}
@@ -0,0 +1,65 @@
+#ifndef AIGSIM_H
+#define AIGSIM_H
+
+#include <vector>
+#include <string>
+#include "aigprog.h"
+#include "aigtrace.h"
+#include "aigout.h"
+#include "aigpipe.h"
+
+// Cycle simulation of a compiled program, one byte per slot.  Latches
+// start at 0.
+class AigSim {
+
+public:
+  AigSim(const AigProgram &program);
+  ~AigSim();
+
+  void reset(void);
+  void step(const unsigned char* inputs, unsigned char* state, unsigned char* outputs);
+  void latchValues(unsigned char* state) const;
+  uint64_t run(string inputFile, string outputFile, bool packedOutput, unsigned columns, unsigned blockCycles);
+  bool openTrace(const string &fileName, AigTextTrace &text, AigTrace &packed, string &error);
+  bool simulate(AigTextTrace* text, const AigTrace* packed, AigOutput &dst, uint64_t limit, unsigned blockCycles, uint64_t &cycles, string &error);
+
+private:
+  const AigProgram &program;
+
+  // value by slot, next latch values
+  vector<unsigned char> values;
+  vector<unsigned char> next;
+
+  // current cycle
+  vector<unsigned char> in;
+  vector<unsigned char> state;
+  vector<unsigned char> out;
+
+  int run_text(AigTextTrace &trace, AigOutput &dst, uint64_t limit, uint64_t &line, uint64_t &cycles);
+  void run_packed(const AigTrace &trace, AigOutput &dst, uint64_t limit, uint64_t &cycles);
+  void unpack_row(const uint64_t* row);
+  unsigned char lit_value(unsigned lit) const;
+};
+
+// 64 simulations of a program at once, bit k of each word belongs to
+// simulation k.  Same cycle as AigSim.
+class AigLaneSim {
+
+public:
+  AigLaneSim(const AigProgram &program);
+  ~AigLaneSim();
+
+  void reset(void);
+  void step(const uint64_t* inputs, uint64_t* state, uint64_t* outputs);
+  void latchValues(uint64_t* state) const;
+
+private:
+  const AigProgram &program;
+
+  vector<uint64_t> values;
+  vector<uint64_t> next;
+
+  uint64_t lit_value(unsigned lit) const;
+};
+
+#endif
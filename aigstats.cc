@@ -0,0 +1,258 @@
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <unistd.h>
+#include <sys/resource.h>
+#ifdef __LINUX__
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#include "aigstats.h"
+
+static const char* counterNames[STATS_COUNTERS] = { "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "dtlb_misses" };
+
+static double clock_seconds(clockid_t clock){
+  struct timespec ts;
+
+  if(clock_gettime(clock, &ts))
+    return 0;
+
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+AigStats::AigStats()
+{
+  unsigned i;
+
+  running = false;
+  wallStart = 0;
+  cpuStart = 0;
+  counting = false;
+  for(i = 0; i < STATS_COUNTERS; i++)
+    fds[i] = -1;
+}
+
+AigStats::~AigStats()
+{
+  close_counters();
+}
+
+// Opens the counters of this process for user space, each separately as
+// not every processor can count all of them at once.  Threads started
+// later are counted when they have exited.  Returns the number opened,
+// the others are left out of the report with the reason.
+unsigned AigStats::openCounters(void){
+  unsigned i, n = 0;
+
+#ifdef __LINUX__
+  static const uint32_t types[STATS_COUNTERS] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE };
+  static const uint64_t configs[STATS_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+    PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)
+  };
+  struct perf_event_attr attr;
+
+  close_counters();
+
+  for(i = 0; i < STATS_COUNTERS; i++){
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = types[i];
+    attr.config = configs[i];
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if(fds[i] >= 0)
+      n++;
+    else if(counterError.empty())
+      counterError = string(counterNames[i]) + ": " + strerror(errno);
+  }
+#else
+  close_counters();
+  counterError = "not supported on this platform";
+#endif
+
+  counting = true;
+  return n;
+}
+
+void AigStats::begin(const char* phase){
+  Phase p;
+  unsigned i;
+
+  end();
+
+  p.name = phase;
+  p.wall = 0;
+  p.cpu = 0;
+  for(i = 0; i < STATS_COUNTERS; i++)
+    p.counts[i] = 0;
+  phases.push_back(p);
+
+  running = true;
+  for(i = 0; i < STATS_COUNTERS; i++)
+    if(fds[i] >= 0 && !read_counter(i, counterStart[i])){
+      close(fds[i]);
+      fds[i] = -1;
+    }
+  wallStart = clock_seconds(CLOCK_MONOTONIC);
+  cpuStart = clock_seconds(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+// processor time is that of all threads, e.g. of the pipeline
+void AigStats::end(void){
+  uint64_t now[3];
+  double value, enabled, active;
+  unsigned i;
+
+  if(!running)
+    return;
+
+  phases.back().wall = clock_seconds(CLOCK_MONOTONIC) - wallStart;
+  phases.back().cpu = clock_seconds(CLOCK_PROCESS_CPUTIME_ID) - cpuStart;
+  running = false;
+
+  // scaled up for the time the counter had to share the hardware
+  for(i = 0; i < STATS_COUNTERS; i++){
+    if(fds[i] < 0 || !read_counter(i, now))
+      continue;
+
+    value = now[0] - counterStart[i][0];
+    enabled = now[1] - counterStart[i][1];
+    active = now[2] - counterStart[i][2];
+    if(active > 0 && active < enabled)
+      value *= enabled / active;
+    phases.back().counts[i] = (uint64_t) value;
+  }
+}
+
+void AigStats::count(const char* name, uint64_t value){
+  char buffer[32];
+
+  sprintf(buffer, "%llu", (unsigned long long) value);
+  values.push_back(make_pair(string(name), string(buffer)));
+}
+
+void AigStats::rate(const char* name, double value){
+  char buffer[32];
+
+  sprintf(buffer, "%.1f", value);
+  values.push_back(make_pair(string(name), string(buffer)));
+}
+
+// each open counter of the phase per unit, e.g. per simulated cycle, as
+// <phase>_<counter>_per_<unit>
+void AigStats::perUnit(const char* phase, const char* unit, double units){
+  uint64_t counts[STATS_COUNTERS];
+  char buffer[32];
+  unsigned i;
+
+  if(units <= 0)
+    return;
+
+  end();
+  phase_counts(phase, counts);
+  for(i = 0; i < STATS_COUNTERS; i++)
+    if(fds[i] >= 0){
+      sprintf(buffer, "%.4f", counts[i] / units);
+      values.push_back(make_pair(string(phase) + "_" + counterNames[i] + "_per_" + unit, string(buffer)));
+    }
+}
+
+double AigStats::wallTime(const char* phase) const{
+  unsigned i;
+
+  for(i = phases.size(); i > 0; i--)
+    if(phases[i - 1].name == phase)
+      return phases[i - 1].wall;
+
+  return 0;
+}
+
+// {"phases":{"load":{"wall_s":..,"cpu_s":..},..},"name":value,..}, a
+// phase that ran twice is reported with its times added up
+void AigStats::write(ostream &out){
+  char buffer[96];
+  unsigned i, j, k;
+  double wall, cpu;
+  uint64_t counts[STATS_COUNTERS];
+
+  end();
+
+  out << "{\"phases\":{";
+  for(i = 0; i < phases.size(); i++){
+    for(j = 0; j < i && phases[j].name != phases[i].name; j++)
+      ;
+    if(j < i)
+      continue;
+
+    wall = cpu = 0;
+    for(j = i; j < phases.size(); j++)
+      if(phases[j].name == phases[i].name){
+        wall += phases[j].wall;
+        cpu += phases[j].cpu;
+      }
+
+    sprintf(buffer, "\"wall_s\":%.6f,\"cpu_s\":%.6f", wall, cpu);
+    out << (i ? "," : "") << "\"" << phases[i].name << "\":{" << buffer;
+
+    phase_counts(phases[i].name, counts);
+    for(k = 0; k < STATS_COUNTERS; k++)
+      if(fds[k] >= 0)
+        out << ",\"" << counterNames[k] << "\":" << counts[k];
+    out << "}";
+  }
+  out << "}";
+
+  for(i = 0; i < values.size(); i++)
+    out << ",\"" << values[i].first << "\":" << values[i].second;
+
+  // the error has no quotes or backslashes
+  if(counting && !counterError.empty())
+    out << ",\"counter_error\":\"" << counterError << "\"";
+  out << "}" << endl;
+}
+
+uint64_t AigStats::peakRss(void){
+  struct rusage usage;
+
+  if(getrusage(RUSAGE_SELF, &usage))
+    return 0;
+
+  return usage.ru_maxrss;
+}
+
+// value, time enabled and time running
+bool AigStats::read_counter(unsigned i, uint64_t* value){
+  return read(fds[i], value, 3 * sizeof(uint64_t)) == 3 * sizeof(uint64_t);
+}
+
+void AigStats::phase_counts(const string &phase, uint64_t* counts) const{
+  unsigned i, k;
+
+  for(k = 0; k < STATS_COUNTERS; k++)
+    counts[k] = 0;
+
+  for(i = 0; i < phases.size(); i++)
+    if(phases[i].name == phase)
+      for(k = 0; k < STATS_COUNTERS; k++)
+        counts[k] += phases[i].counts[k];
+}
+
+void AigStats::close_counters(void){
+  unsigned i;
+
+  for(i = 0; i < STATS_COUNTERS; i++){
+    if(fds[i] >= 0)
+      close(fds[i]);
+    fds[i] = -1;
+  }
+}
@@ -0,0 +1,65 @@
+#ifndef AIGSTATS_H
+#define AIGSTATS_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <stdint.h>
+#include "aignode.h"
+
+// cycles, instructions, L1 data, last level cache, branch and data TLB
+// misses
+#define STATS_COUNTERS 6
+
+// Wall and processor time of the phases of a run, and named counts and
+// rates, written as one line of JSON.  Phases don't nest, begin() ends
+// the running one.  With openCounters() each phase also gets the hardware
+// counters of the process and the threads it starts.
+class AigStats {
+
+public:
+  AigStats();
+  ~AigStats();
+
+  unsigned openCounters(void);
+  void begin(const char* phase);
+  void end(void);
+  void count(const char* name, uint64_t value);
+  void rate(const char* name, double value);
+  void perUnit(const char* phase, const char* unit, double units);
+  // seconds of the last phase of that name, 0 if there is none
+  double wallTime(const char* phase) const;
+  void write(ostream &out);
+
+  // kilobytes, 0 if unknown
+  static uint64_t peakRss(void);
+
+private:
+  struct Phase
+  {
+    string name;
+    double wall;
+    double cpu;
+    uint64_t counts[STATS_COUNTERS];
+  };
+
+  vector<Phase> phases;
+  vector<pair<string, string> > values;
+  bool running;
+  double wallStart;
+  double cpuStart;
+
+  // -1 if not open
+  int fds[STATS_COUNTERS];
+  bool counting;
+  // why the first one that failed didn't open
+  string counterError;
+  // value, time enabled and running at the start of the phase
+  uint64_t counterStart[STATS_COUNTERS][3];
+
+  bool read_counter(unsigned i, uint64_t* value);
+  void phase_counts(const string &phase, uint64_t* counts) const;
+  void close_counters(void);
+};
+
+#endif
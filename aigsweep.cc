@@ -0,0 +1,238 @@
+#include <iostream>
+#include <algorithm>
+#include "aigsweep.h"
+
+AigSweep::AigSweep(AigDef &mgr, vector<AigNode*> &inputs, vector<AigNode*> &latches, vector<AigNode*> &latchLogic, vector<AigNode*> &outputs)
+  : mgr(mgr), inputs(inputs), latches(latches), latchLogic(latchLogic), outputs(outputs)
+{
+  seed = 88172645463325252ULL;
+}
+
+AigSweep::~AigSweep()
+{
+
+}
+
+// Group latches and ands by their values over random runs from the reset
+// state, keep the groups that agree on further validation runs and merge
+// every member into the lowest numbered node of its group.
+void AigSweep::sweep(unsigned validationCycles, bool verbose){
+  unsigned i, j, id, n, rep, cycle, oldLatches, oldNodes;
+  uint64_t word;
+  AigNode* node;
+  AigLit lit, left, right;
+
+  compile();
+  n = mgr.numNodeIds();
+  oldLatches = latches.size();
+  oldNodes = n;
+
+  // candidate signatures, normalized to a zero first bit
+  vector<uint64_t> signature(n, 14695981039346656037ULL);
+  reset();
+  for(cycle = 0; cycle < SWEEP_CANDIDATE_CYCLES; cycle++){
+    simulate_cycle();
+    for(id = 0; id < n; id++){
+      if(cycle == 0)
+        phase[id] = values[id] & 1;
+
+      word = phase[id] ? ~values[id] : values[id];
+      signature[id] = (signature[id] ^ word) * 1099511628211ULL;
+    }
+  }
+
+  vector<pair<uint64_t, unsigned> > order(n);
+  for(id = 0; id < n; id++)
+    order[id] = make_pair(signature[id], id);
+  sort(order.begin(), order.end());
+
+  // representative of each candidate, inputs and constants are never merged
+  vector<unsigned> repOf(n);
+  for(i = 0; i < n; i = j){
+    rep = order[i].second;
+    repOf[rep] = rep;
+    for(j = i + 1; j < n && order[j].first == order[i].first; j++){
+      id = order[j].second;
+      repOf[id] = (mgr.idNode(id)->is_input() || mgr.idNode(id)->is_const()) ? id : rep;
+    }
+  }
+
+  // drop candidates that disagree with their representative
+  reset();
+  seed ^= 0x9E3779B97F4A7C15ULL;
+  for(cycle = 0; cycle < validationCycles; cycle++){
+    simulate_cycle();
+    for(id = 0; id < n; id++){
+      rep = repOf[id];
+      if(rep == id)
+        continue;
+
+      word = values[id] ^ values[rep];
+      if(phase[id] != phase[rep])
+        word = ~word;
+      if(word)
+        repOf[id] = id;
+    }
+  }
+
+  // rebuild with merged nodes replaced by their representatives
+  mergedNodes.clear();
+  mergedReps.clear();
+  vector<AigLit> newLit(n);
+  for(id = 0; id < n; id++){
+    node = mgr.idNode(id);
+    rep = repOf[id];
+
+    if(rep != id){
+      lit = newLit[rep];
+      lit.pol ^= (phase[id] != phase[rep]);
+      newLit[id] = lit;
+
+      // inverters added for complemented outputs have no source literal
+      if(node->is_and() && (node->get_left()->is_const() || node->get_right()->is_const()))
+        continue;
+
+      lit = mgr.NodeLit(mgr.idNode(rep));
+      lit.pol ^= (phase[id] != phase[rep]);
+      mergedNodes.push_back(node);
+      mergedReps.push_back(lit);
+    }
+    else if(node->is_and()){
+      left = newLit[node->get_left()->get_id()];
+      left.pol ^= node->get_lpol();
+      right = newLit[node->get_right()->get_id()];
+      right.pol ^= node->get_rpol();
+      newLit[id] = mgr.AndLit(left, right);
+    }
+    else
+      newLit[id] = mgr.NodeLit(node);
+  }
+
+  // merged latches leave the design together with their next state logic
+  for(i = 0, j = 0; i < latches.size(); i++){
+    lit = newLit[latchLogic[i]->get_id()];
+    node = mgr.LitNode(lit);
+    node->ref_inc();
+    latchLogic[i]->ref_dec();
+
+    if(repOf[latches[i]->get_id()] != latches[i]->get_id()){
+      node->ref_dec();
+      continue;
+    }
+
+    latches[j] = latches[i];
+    latchLogic[j] = node;
+    j++;
+  }
+  latches.resize(j);
+  latchLogic.resize(j);
+
+  for(i = 0; i < outputs.size(); i++){
+    node = mgr.LitNode(newLit[outputs[i]->get_id()]);
+    node->ref_inc();
+    outputs[i]->ref_dec();
+    outputs[i] = node;
+  }
+
+  mgr.clean();
+  mgr.buildFanout(inputs, latches, latchLogic, outputs);
+
+  if(verbose){
+    cout << "     * merged " << mergedNodes.size() << " nodes" << endl;
+    cout << "     * latches " << oldLatches << " -> " << latches.size() << ", nodes " << oldNodes << " -> " << mgr.numNodeIds() << endl;
+  }
+}
+
+// one line per merged node: its literal and the literal replacing it
+void AigSweep::writeMap(ostream &out) const{
+  unsigned i;
+  AigLit lit;
+
+  for(i = 0; i < mergedNodes.size(); i++){
+    lit.node = mergedNodes[i];
+    lit.pol = false;
+
+    out << (mergedNodes[i]->is_latch() ? "latch " : "and ") << aiger_lit(lit) << " " << aiger_lit(mergedReps[i]) << endl;
+  }
+}
+
+// number nodes and flatten the fanins for word parallel simulation
+void AigSweep::compile(void){
+  unsigned id, n;
+  AigNode* node;
+
+  mgr.buildFanout(inputs, latches, latchLogic, outputs);
+  n = mgr.numNodeIds();
+
+  fanin0.assign(n, 0);
+  fanin1.assign(n, 0);
+  for(id = 0; id < n; id++){
+    node = mgr.idNode(id);
+    if(!node->is_and())
+      continue;
+
+    fanin0[id] = node->get_left()->get_id() * 2 + node->get_lpol();
+    fanin1[id] = node->get_right()->get_id() * 2 + node->get_rpol();
+  }
+
+  values.assign(n, 0);
+  latchNext.assign(latches.size(), 0);
+  phase.assign(n, false);
+}
+
+// all latches start at zero, as in AigSim
+void AigSweep::reset(void){
+  unsigned i;
+
+  for(i = 0; i < latchNext.size(); i++)
+    latchNext[i] = 0;
+}
+
+// 64 random patterns per cycle, latches advance to their next state
+void AigSweep::simulate_cycle(void){
+  unsigned i, id, n;
+  uint64_t left, right;
+
+  n = values.size();
+  values[mgr.Zero()->get_id()] = 0;
+  values[mgr.One()->get_id()] = ~0ULL;
+
+  for(i = 0; i < inputs.size(); i++)
+    values[inputs[i]->get_id()] = random();
+
+  for(i = 0; i < latches.size(); i++)
+    values[latches[i]->get_id()] = latchNext[i];
+
+  for(id = 0; id < n; id++){
+    if(!mgr.idNode(id)->is_and())
+      continue;
+
+    left = values[fanin0[id] >> 1];
+    if(fanin0[id] & 1)
+      left = ~left;
+    right = values[fanin1[id] >> 1];
+    if(fanin1[id] & 1)
+      right = ~right;
+
+    values[id] = left & right;
+  }
+
+  for(i = 0; i < latches.size(); i++)
+    latchNext[i] = values[latchLogic[i]->get_id()];
+}
+
+// xorshift64
+uint64_t AigSweep::random(void){
+  seed ^= seed << 13;
+  seed ^= seed >> 7;
+  seed ^= seed << 17;
+  return seed;
+}
+
+// aiger literal of an edge in terms of the source file indices
+unsigned AigSweep::aiger_lit(AigLit lit) const{
+  if(lit.node->is_const())
+    return (lit.node == mgr.One()) ^ lit.pol;
+
+  return lit.node->get_index() * 2 + lit.pol;
+}
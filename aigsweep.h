@@ -0,0 +1,46 @@
+#ifndef AIGSWEEP_H
+#define AIGSWEEP_H
+
+#include <vector>
+#include <ostream>
+#include <stdint.h>
+#include "aig.h"
+
+#define SWEEP_CANDIDATE_CYCLES 64
+
+class AigSweep {
+
+public:
+  AigSweep(AigDef &mgr, vector<AigNode*> &inputs, vector<AigNode*> &latches, vector<AigNode*> &latchLogic, vector<AigNode*> &outputs);
+  ~AigSweep();
+
+  void sweep(unsigned validationCycles, bool verbose);
+  void writeMap(ostream &out) const;
+
+private:
+  AigDef &mgr;
+  vector<AigNode*> &inputs;
+  vector<AigNode*> &latches;
+  vector<AigNode*> &latchLogic;
+  vector<AigNode*> &outputs;
+
+  // fanin literals (id * 2 + complement) by id, ands only
+  vector<unsigned> fanin0;
+  vector<unsigned> fanin1;
+  vector<uint64_t> values;
+  vector<uint64_t> latchNext;
+  vector<bool> phase;
+  uint64_t seed;
+
+  // merged node and its representative edge
+  vector<AigNode*> mergedNodes;
+  vector<AigLit> mergedReps;
+
+  void compile(void);
+  void reset(void);
+  void simulate_cycle(void);
+  uint64_t random(void);
+  unsigned aiger_lit(AigLit lit) const;
+};
+
+#endif
@@ -0,0 +1,169 @@
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+#include "aigsym.h"
+#include "aiger_cc.h"
+
+static bool symbol_less(const AigSymbol &a, const AigSymbol &b){
+  int cmp = strcmp(a.name, b.name);
+
+  if(cmp)
+    return cmp < 0;
+
+  return a.kind < b.kind;
+}
+
+AigSymbols::AigSymbols()
+{
+  offset = 0;
+  numOutputs = 0;
+  indexed = false;
+  pool = NULL;
+}
+
+AigSymbols::~AigSymbols()
+{
+  free(pool);
+}
+
+void AigSymbols::setSource(const string &fileName, size_t offset, const vector<unsigned> &inputLits, const vector<unsigned> &latchLits, unsigned numOutputs){
+  this->fileName = fileName;
+  this->offset = offset;
+  this->inputLits = inputLits;
+  this->latchLits = latchLits;
+  this->numOutputs = numOutputs;
+}
+
+const char* AigSymbols::inputName(unsigned pos){
+  index();
+  return pos < inputNames.size() ? inputNames[pos] : NULL;
+}
+
+const char* AigSymbols::latchName(unsigned pos){
+  index();
+  return pos < latchNames.size() ? latchNames[pos] : NULL;
+}
+
+const char* AigSymbols::outputName(unsigned pos){
+  index();
+  return pos < outputNames.size() ? outputNames[pos] : NULL;
+}
+
+// name of an input or latch literal, outputs may share literals
+const char* AigSymbols::litName(unsigned lit){
+  vector<pair<unsigned, const char*> >::iterator it;
+
+  index();
+  it = lower_bound(byLit.begin(), byLit.end(), make_pair(aiger_strip(lit), (const char*) NULL));
+  if(it == byLit.end() || it->first != aiger_strip(lit))
+    return NULL;
+
+  return it->second;
+}
+
+bool AigSymbols::findInput(const char* name, unsigned &pos){
+  return find('i', name, pos);
+}
+
+bool AigSymbols::findLatch(const char* name, unsigned &pos){
+  return find('l', name, pos);
+}
+
+bool AigSymbols::findOutput(const char* name, unsigned &pos){
+  return find('o', name, pos);
+}
+
+unsigned AigSymbols::numComments(void){
+  index();
+  return comments.size();
+}
+
+const char* AigSymbols::comment(unsigned i){
+  index();
+  return i < comments.size() ? comments[i] : NULL;
+}
+
+bool AigSymbols::find(char kind, const char* name, unsigned &pos){
+  AigSymbol key;
+  vector<AigSymbol>::iterator it;
+
+  index();
+  key.name = name;
+  key.kind = kind;
+  key.pos = 0;
+
+  it = lower_bound(byName.begin(), byName.end(), key, symbol_less);
+  if(it == byName.end() || it->kind != kind || strcmp(it->name, name))
+    return false;
+
+  pos = it->pos;
+  return true;
+}
+
+// Lines 'i<pos> <name>', 'l<pos> <name>' and 'o<pos> <name>', optionally
+// followed by 'c' and one comment per line.  Indexing stops at the first
+// malformed line.
+void AigSymbols::index(void){
+  char *p, *end, *line, *name;
+  size_t size;
+  unsigned pos;
+  AigSymbol symbol;
+  vector<const char*>* names;
+
+  if(indexed)
+    return;
+
+  indexed = true;
+  inputNames.assign(inputLits.size(), NULL);
+  latchNames.assign(latchLits.size(), NULL);
+  outputNames.assign(numOutputs, NULL);
+
+  pool = aiger_read_tail(fileName.c_str(), offset, &size);
+  if(!pool)
+    return;
+
+  pool[size] = 0;
+  end = pool + size;
+  for(p = pool; p < end; p++)
+    if(*p == '\n')
+      *p = 0;
+
+  for(line = pool; line < end; line += strlen(line) + 1){
+    if(!strcmp(line, "c")){
+      for(line += 2; line < end; line += strlen(line) + 1)
+        comments.push_back(line);
+      break;
+    }
+
+    if(line[0] == 'i')
+      names = &inputNames;
+    else if(line[0] == 'l')
+      names = &latchNames;
+    else if(line[0] == 'o')
+      names = &outputNames;
+    else
+      break;
+
+    if(!isdigit(line[1]))
+      break;
+
+    pos = strtoul(line + 1, &name, 10);
+    if(*name != ' ' || !name[1] || pos >= names->size() || (*names)[pos])
+      break;
+
+    (*names)[pos] = ++name;
+    symbol.name = name;
+    symbol.kind = line[0];
+    symbol.pos = pos;
+    byName.push_back(symbol);
+
+    if(line[0] == 'i')
+      byLit.push_back(make_pair(inputLits[pos], (const char*) name));
+    else if(line[0] == 'l')
+      byLit.push_back(make_pair(latchLits[pos], (const char*) name));
+  }
+
+  sort(byName.begin(), byName.end(), symbol_less);
+  sort(byLit.begin(), byLit.end());
+}
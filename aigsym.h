@@ -0,0 +1,63 @@
+#ifndef AIGSYM_H
+#define AIGSYM_H
+
+#include <vector>
+#include <string>
+#include "aignode.h"
+
+// named input, latch or output position
+struct AigSymbol
+{
+  const char* name;
+  char kind;
+  unsigned pos;
+};
+
+// Symbol table and comments of an aiger file.  Loading only records where
+// they start, the section is read and indexed on the first query.
+class AigSymbols {
+
+public:
+  AigSymbols();
+  ~AigSymbols();
+
+  void setSource(const string &fileName, size_t offset, const vector<unsigned> &inputLits, const vector<unsigned> &latchLits, unsigned numOutputs);
+
+  const char* inputName(unsigned pos);
+  const char* latchName(unsigned pos);
+  const char* outputName(unsigned pos);
+  const char* litName(unsigned lit);
+
+  bool findInput(const char* name, unsigned &pos);
+  bool findLatch(const char* name, unsigned &pos);
+  bool findOutput(const char* name, unsigned &pos);
+
+  unsigned numComments(void);
+  const char* comment(unsigned i);
+
+private:
+  string fileName;
+  size_t offset;
+  vector<unsigned> inputLits;
+  vector<unsigned> latchLits;
+  unsigned numOutputs;
+  bool indexed;
+
+  // the whole section, new lines replaced by zeros
+  char* pool;
+
+  // names by position, NULL if unnamed
+  vector<const char*> inputNames;
+  vector<const char*> latchNames;
+  vector<const char*> outputNames;
+  vector<const char*> comments;
+
+  // symbols sorted by name, named input and latch literals sorted
+  vector<AigSymbol> byName;
+  vector<pair<unsigned, const char*> > byLit;
+
+  void index(void);
+  bool find(char kind, const char* name, unsigned &pos);
+};
+
+#endif
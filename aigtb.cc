@@ -0,0 +1,181 @@
+#include <cstring>
+#include "aigtb.h"
+
+// a design instance and its lane values, bit k for lane k
+struct AigLaneGroup
+{
+  aigsim* handle;
+  unsigned used;
+  std::vector<uint64_t> inputs;
+  std::vector<uint64_t> latches;
+  std::vector<uint64_t> outputs;
+
+  AigLaneGroup() : handle(nullptr), used(0) {}
+  ~AigLaneGroup(){ aigsim_close(handle); }
+};
+
+void AigLane::setInput(unsigned i, bool value){
+  if(value)
+    group->inputs[i] |= mask;
+  else
+    group->inputs[i] &= ~mask;
+}
+
+bool AigLane::output(unsigned i) const{
+  return group->outputs[i] & mask;
+}
+
+bool AigLane::latch(unsigned i) const{
+  return group->latches[i] & mask;
+}
+
+uint64_t AigLane::cycle(void) const{
+  return scheduler->cycles;
+}
+
+unsigned AigLane::index(void) const{
+  return number;
+}
+
+AigScheduler::AigScheduler()
+{
+  flags = 0;
+  message[0] = 0;
+  cycles = 0;
+}
+
+AigScheduler::~AigScheduler()
+{
+
+}
+
+bool AigScheduler::load(const char* fileName, unsigned flags){
+  running.clear();
+  pending.clear();
+  lanes.clear();
+  groups.clear();
+  cycles = 0;
+
+  this->fileName.assign(fileName, fileName + strlen(fileName) + 1);
+  this->flags = flags;
+
+  return open_group();
+}
+
+const char* AigScheduler::error(void) const{
+  return message;
+}
+
+unsigned AigScheduler::numInputs(void) const{
+  return groups.empty() ? 0 : aigsim_num_inputs(groups.front()->handle);
+}
+
+unsigned AigScheduler::numLatches(void) const{
+  return groups.empty() ? 0 : aigsim_num_latches(groups.front()->handle);
+}
+
+unsigned AigScheduler::numOutputs(void) const{
+  return groups.empty() ? 0 : aigsim_num_outputs(groups.front()->handle);
+}
+
+AigLane* AigScheduler::newLane(void){
+  AigLane* lane;
+
+  if(groups.empty()){
+    strcpy(message, "no design loaded");
+    return nullptr;
+  }
+
+  if(groups.back()->used == AIGSIM_LANES && !open_group())
+    return nullptr;
+
+  lane = new AigLane;
+  lane->scheduler = this;
+  lane->group = groups.back().get();
+  lane->mask = (uint64_t) 1 << lane->group->used++;
+  lane->number = lanes.size();
+  lanes.emplace_back(lane);
+
+  return lane;
+}
+
+void AigScheduler::add(AigTestbench bench){
+  pending.push_back(std::move(bench));
+}
+
+// Each cycle all groups are stepped, then every bench runs up to its
+// next edge.  Benches added meanwhile start with the following cycle.
+uint64_t AigScheduler::run(uint64_t limit){
+  uint64_t n;
+  AigLaneGroup* group;
+
+  start_pending();
+
+  for(n = 0; !running.empty() && (!limit || n < limit); n++){
+    for(const std::unique_ptr<AigLaneGroup> &g : groups){
+      group = g.get();
+      aigsim_set_lane_inputs(group->handle, group->inputs.data());
+      aigsim_step_lanes(group->handle, 1);
+      aigsim_get_lane_outputs(group->handle, group->outputs.data());
+      aigsim_get_lane_latches(group->handle, group->latches.data());
+    }
+    cycles++;
+
+    resume_running();
+    start_pending();
+  }
+
+  return n;
+}
+
+uint64_t AigScheduler::cycle(void) const{
+  return cycles;
+}
+
+unsigned AigScheduler::numRunning(void) const{
+  return running.size() + pending.size();
+}
+
+// Lanes start with the latches at 0 and the inputs low, those of a group
+// opened while running too.
+bool AigScheduler::open_group(void){
+  std::unique_ptr<AigLaneGroup> group(new AigLaneGroup);
+
+  group->handle = aigsim_open_file(fileName.data(), flags, message, sizeof(message));
+  if(!group->handle)
+    return false;
+
+  group->inputs.assign(aigsim_num_inputs(group->handle) + 1, 0);
+  group->latches.assign(aigsim_num_latches(group->handle) + 1, 0);
+  group->outputs.assign(aigsim_num_outputs(group->handle) + 1, 0);
+  groups.push_back(std::move(group));
+
+  return true;
+}
+
+void AigScheduler::start_pending(void){
+  std::vector<AigTestbench> started;
+
+  started.swap(pending);
+  for(AigTestbench &bench : started){
+    bench.handle.resume();
+    if(!bench.done())
+      running.push_back(std::move(bench));
+  }
+}
+
+// finished benches are dropped, the others keep their order
+void AigScheduler::resume_running(void){
+  size_t i, j;
+
+  for(i = 0, j = 0; i < running.size(); i++){
+    running[i].handle.resume();
+    if(running[i].done())
+      continue;
+
+    if(i != j)
+      running[j] = std::move(running[i]);
+    j++;
+  }
+  running.erase(running.begin() + j, running.end());
+}
@@ -0,0 +1,149 @@
+#ifndef AIGTB_H
+#define AIGTB_H
+
+// C++20 coroutine testbenches on libaigsim, for stimulus that depends on
+// the outputs.  A testbench is a coroutine returning AigTestbench that
+// drives its AigLane: it sets inputs, co_awaits lane.edge() and reads the
+// outputs of that cycle.  Each lane is one bit of the pattern parallel simulation,
+// the scheduler steps all lanes of a design instance at once and resumes
+// the benches in between, on the calling thread.
+//
+//   AigTestbench count(AigLane &lane){
+//     lane.setInput(0, true);
+//     while(!lane.output(0))
+//       co_await lane.edge();
+//   }
+//
+//   AigScheduler scheduler;
+//   scheduler.load("counter.aig");
+//   scheduler.add(count(*scheduler.newLane()));
+//   scheduler.run(0);
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <vector>
+#include <stdint.h>
+#include "libaigsim.h"
+
+class AigScheduler;
+struct AigLaneGroup;
+
+// Handle of a testbench coroutine, it stays suspended until the scheduler
+// it is added to runs.
+class AigTestbench {
+
+public:
+  struct promise_type {
+    AigTestbench get_return_object(void){ return AigTestbench(std::coroutine_handle<promise_type>::from_promise(*this)); }
+    std::suspend_always initial_suspend(void) noexcept { return {}; }
+    std::suspend_always final_suspend(void) noexcept { return {}; }
+    void return_void(void){}
+    void unhandled_exception(void){ std::terminate(); }
+  };
+
+  AigTestbench(AigTestbench &&other) noexcept : handle(other.handle) { other.handle = nullptr; }
+  ~AigTestbench(){ if(handle) handle.destroy(); }
+
+  AigTestbench& operator=(AigTestbench &&other) noexcept {
+    if(this != &other){
+      if(handle)
+        handle.destroy();
+      handle = other.handle;
+      other.handle = nullptr;
+    }
+    return *this;
+  }
+
+  AigTestbench(const AigTestbench&) = delete;
+  AigTestbench& operator=(const AigTestbench&) = delete;
+
+  bool done(void) const { return !handle || handle.done(); }
+
+private:
+  friend class AigScheduler;
+  std::coroutine_handle<promise_type> handle;
+
+  explicit AigTestbench(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+};
+
+// One simulation of the design, driven by one testbench.
+class AigLane {
+
+public:
+  // co_await lane.edge() steps a cycle, the scheduler resumes the bench
+  // when the outputs of the cycle are there
+  struct Edge {
+    bool await_ready(void) const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<>) const noexcept {}
+    void await_resume(void) const noexcept {}
+  };
+
+  Edge edge(void) const { return Edge(); }
+
+  // the input holds its value until set again
+  void setInput(unsigned i, bool value);
+  // outputs of the last cycle and the latch values the next one starts with
+  bool output(unsigned i) const;
+  bool latch(unsigned i) const;
+  // cycles stepped
+  uint64_t cycle(void) const;
+  unsigned index(void) const;
+
+private:
+  friend class AigScheduler;
+  AigScheduler* scheduler;
+  AigLaneGroup* group;
+  uint64_t mask;
+  unsigned number;
+};
+
+// Runs the benches, a design instance per AIGSIM_LANES lanes.
+class AigScheduler {
+
+public:
+  AigScheduler();
+  ~AigScheduler();
+
+  AigScheduler(const AigScheduler&) = delete;
+  AigScheduler& operator=(const AigScheduler&) = delete;
+
+  // the design is loaded again for each group of lanes
+  bool load(const char* fileName, unsigned flags = 0);
+  const char* error(void) const;
+
+  // 0 without a design
+  unsigned numInputs(void) const;
+  unsigned numLatches(void) const;
+  unsigned numOutputs(void) const;
+
+  // NULL with error() set if another design instance can't be loaded
+  AigLane* newLane(void);
+  void add(AigTestbench bench);
+
+  // Steps until all benches returned or for at most limit cycles, 0 is
+  // no limit.  Returns the cycles stepped.
+  uint64_t run(uint64_t limit);
+  uint64_t cycle(void) const;
+  unsigned numRunning(void) const;
+
+private:
+  friend class AigLane;
+
+  std::vector<char> fileName;
+  unsigned flags;
+  char message[128];
+  uint64_t cycles;
+
+  std::vector<std::unique_ptr<AigLaneGroup> > groups;
+  std::vector<std::unique_ptr<AigLane> > lanes;
+  // added but not resumed yet, and suspended at an edge
+  std::vector<AigTestbench> pending;
+  std::vector<AigTestbench> running;
+
+  bool open_group(void);
+  void start_pending(void);
+  void resume_running(void);
+};
+
+#endif
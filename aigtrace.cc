@@ -0,0 +1,409 @@
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "aigtrace.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+AigTrace::AigTrace()
+{
+  map = NULL;
+  mapSize = 0;
+  header = NULL;
+  rows = NULL;
+  words = 0;
+}
+
+AigTrace::~AigTrace()
+{
+  close();
+}
+
+// Maps a packed trace, false with error() set if it is not one or its
+// size doesn't match the header.
+bool AigTrace::open(const string &fileName){
+  int fd;
+  struct stat st;
+  void* data;
+
+  close();
+
+  fd = ::open(fileName.c_str(), O_RDONLY);
+  if(fd < 0){
+    message = "Unable to open file " + fileName;
+    return false;
+  }
+
+  if(fstat(fd, &st) || (size_t) st.st_size < sizeof(AigTraceHeader)){
+    ::close(fd);
+    message = "Invalid packed trace " + fileName;
+    return false;
+  }
+
+  data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if(data == MAP_FAILED){
+    message = "Unable to map file " + fileName;
+    return false;
+  }
+
+  if(!attach(data, st.st_size)){
+    munmap(data, st.st_size);
+    message = "Invalid packed trace " + fileName;
+    return false;
+  }
+
+  // sequential access, read ahead
+  madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+  map = data;
+  mapSize = st.st_size;
+
+  return true;
+}
+
+// Uses a packed trace in memory, aligned to 64 bits, that outlives it.
+bool AigTrace::attach(const void* data, size_t size){
+  const AigTraceHeader* h = (const AigTraceHeader*) data;
+  uint64_t rowBytes;
+
+  if(size < sizeof(AigTraceHeader)){
+    message = "Invalid packed trace";
+    return false;
+  }
+
+  rowBytes = (uint64_t) ((h->numInputs + 63) / 64) * sizeof(uint64_t);
+
+  if(memcmp(h->magic, TRACE_MAGIC, sizeof(h->magic)) || h->version != TRACE_VERSION
+     || (rowBytes && h->numCycles > (uint64_t) (size - sizeof(AigTraceHeader)) / rowBytes)
+     || (uint64_t) size != sizeof(AigTraceHeader) + h->numCycles * rowBytes){
+    message = "Invalid packed trace";
+    return false;
+  }
+
+  header = h;
+  rows = (const uint64_t*) (h + 1);
+  words = rowBytes / sizeof(uint64_t);
+
+  return true;
+}
+
+bool AigTrace::isOpen(void) const{
+  return header != NULL;
+}
+
+void AigTrace::close(void){
+  if(map)
+    munmap(map, mapSize);
+
+  map = NULL;
+  mapSize = 0;
+  header = NULL;
+  rows = NULL;
+  words = 0;
+}
+
+const string& AigTrace::error(void) const{
+  return message;
+}
+
+// text traces never start with the magic
+bool AigTrace::isPacked(const string &fileName){
+  char magic[8];
+  int fd;
+  bool packed;
+
+  fd = ::open(fileName.c_str(), O_RDONLY);
+  if(fd < 0)
+    return false;
+
+  packed = read(fd, magic, sizeof(magic)) == sizeof(magic) && !memcmp(magic, TRACE_MAGIC, sizeof(magic));
+  ::close(fd);
+
+  return packed;
+}
+
+unsigned AigTrace::numInputs(void) const{
+  return header->numInputs;
+}
+
+uint64_t AigTrace::numCycles(void) const{
+  return header->numCycles;
+}
+
+unsigned AigTrace::rowWords(void) const{
+  return words;
+}
+
+const uint64_t* AigTrace::row(uint64_t cycle) const{
+  return rows + cycle * words;
+}
+
+// Packs the first column of each line, so sim output files work as well.
+// The first line sets the number of inputs, like in sim the first line of
+// another length ends the trace.
+bool AigTrace::pack(const string &textFile, const string &packedFile, string &error){
+  AigTraceHeader h;
+  string line;
+  size_t i, len;
+  char buffer[64];
+  vector<uint64_t> row;
+
+  ifstream in(textFile.c_str(), ios::in);
+  if(!in.is_open()){
+    error = "Unable to open file " + textFile;
+    return false;
+  }
+
+  ofstream out(packedFile.c_str(), ios::out | ios::binary);
+  if(!out.is_open()){
+    error = "Unable to open file " + packedFile;
+    return false;
+  }
+
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, TRACE_MAGIC, sizeof(h.magic));
+  h.version = TRACE_VERSION;
+  out.write((const char*) &h, sizeof(h));
+
+  while(getline(in, line)){
+    len = line.find_first_of(" \r");
+    if(len == string::npos)
+      len = line.size();
+
+    if(!h.numCycles){
+      h.numInputs = len;
+      row.resize((len + 63) / 64);
+    }
+    else if(len != h.numInputs)
+      break;
+
+    fill(row.begin(), row.end(), 0);
+    for(i = 0; i < len; i++){
+      if(line[i] == '1')
+        row[i / 64] |= (uint64_t) 1 << (i % 64);
+      else if(line[i] != '0'){
+        sprintf(buffer, "Invalid input value on line %llu", (unsigned long long) h.numCycles + 1);
+        error = buffer;
+        out.close();
+        unlink(packedFile.c_str());
+        return false;
+      }
+    }
+
+    if(!row.empty())
+      out.write((const char*) &row[0], row.size() * sizeof(uint64_t));
+    h.numCycles++;
+  }
+
+  out.seekp(0);
+  out.write((const char*) &h, sizeof(h));
+  out.close();
+
+  if(out.fail()){
+    error = "Unable to write file " + packedFile;
+    return false;
+  }
+
+  return true;
+}
+
+// back to text lines ending in CR LF
+bool AigTrace::unpack(const string &packedFile, const string &textFile, string &error){
+  AigTrace trace;
+  uint64_t c;
+  unsigned i;
+  const uint64_t* row;
+  string line;
+
+  if(!trace.open(packedFile)){
+    error = trace.error();
+    return false;
+  }
+
+  ofstream out(textFile.c_str(), ios::out | ios::binary);
+  if(!out.is_open()){
+    error = "Unable to open file " + textFile;
+    return false;
+  }
+
+  line.resize(trace.numInputs() + 2);
+  line[trace.numInputs()] = '\r';
+  line[trace.numInputs() + 1] = '\n';
+
+  for(c = 0; c < trace.numCycles(); c++){
+    row = trace.row(c);
+    for(i = 0; i < trace.numInputs(); i++)
+      line[i] = '0' + ((row[i / 64] >> (i % 64)) & 1);
+    out << line;
+  }
+
+  out.close();
+  if(out.fail()){
+    error = "Unable to write file " + textFile;
+    return false;
+  }
+
+  return true;
+}
+
+AigTextTrace::AigTextTrace()
+{
+  fd = -1;
+  eof = false;
+  numInputs = 0;
+  lineNo = 0;
+  cur = end = NULL;
+}
+
+AigTextTrace::~AigTextTrace()
+{
+  close();
+}
+
+bool AigTextTrace::open(const string &fileName, unsigned numInputs){
+  size_t size;
+
+  close();
+
+  fd = ::open(fileName.c_str(), O_RDONLY);
+  if(fd < 0)
+    return false;
+
+  this->numInputs = numInputs;
+  eof = false;
+  lineNo = 0;
+
+  // two lines always fit
+  size = 2 * ((size_t) numInputs + 2);
+  if(size < TRACE_BLOCK_SIZE)
+    size = TRACE_BLOCK_SIZE;
+  buffer.assign(size + TRACE_PADDING, 0);
+  cur = end = &buffer[0];
+  words.assign((numInputs + 63) / 64 + 1, 0);
+
+  return true;
+}
+
+void AigTextTrace::close(void){
+  if(fd >= 0)
+    ::close(fd);
+
+  fd = -1;
+}
+
+// The line is checked for its length first, like getline() and size()
+// did, only then for its values.
+int AigTextTrace::next(const uint64_t* &row){
+  size_t avail;
+
+  fill(numInputs + 2);
+  avail = end - cur;
+
+  if(avail < (size_t) numInputs + 1 || cur[numInputs] == '\n' || (avail > numInputs + 1 && cur[numInputs + 1] != '\n'))
+    return 0;
+
+  lineNo++;
+  if(!pack(cur)){
+    // an earlier LF is a shorter line
+    if(memchr(cur, '\n', numInputs))
+      return 0;
+
+    return -1;
+  }
+
+  // the last line may end without LF
+  cur += avail > numInputs + 1 ? numInputs + 2 : numInputs + 1;
+  row = &words[0];
+
+  return 1;
+}
+
+uint64_t AigTextTrace::line(void) const{
+  return lineNo;
+}
+
+// Moves the unread bytes to the front and reads until need bytes are
+// there or the file ends.
+void AigTextTrace::fill(size_t need){
+  size_t capacity = buffer.size() - TRACE_PADDING;
+  ssize_t n;
+
+  if((size_t) (end - cur) >= need || eof)
+    return;
+
+  memmove(&buffer[0], cur, end - cur);
+  end = &buffer[0] + (end - cur);
+  cur = &buffer[0];
+
+  while(end < &buffer[0] + capacity){
+    n = read(fd, end, &buffer[0] + capacity - end);
+    if(n < 0 && errno == EINTR)
+      continue;
+
+    if(n <= 0){
+      eof = true;
+      break;
+    }
+    end += n;
+  }
+}
+
+// false if one of the values is not '0' or '1'
+bool AigTextTrace::pack(const char* values){
+  unsigned w, k, n;
+  uint64_t bits;
+
+#ifdef __SSE2__
+  const __m128i one = _mm_set1_epi8(1);
+  const __m128i ascii1 = _mm_set1_epi8('1');
+  __m128i v;
+  unsigned valid, ones, mask;
+
+  // bytes '0' and '1' or 1 give '1', the padding covers the loads past
+  // the line
+  for(w = 0; w * 64 < numInputs; w++){
+    bits = 0;
+    for(k = 0; k < 64 && w * 64 + k < numInputs; k += 16){
+      n = numInputs - (w * 64 + k);
+      mask = n < 16 ? (1u << n) - 1 : 0xffff;
+
+      v = _mm_loadu_si128((const __m128i*) (values + w * 64 + k));
+      valid = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_or_si128(v, one), ascii1));
+      ones = _mm_movemask_epi8(_mm_cmpeq_epi8(v, ascii1));
+
+      if((valid & mask) != mask)
+        return false;
+
+      bits |= (uint64_t) (ones & mask) << k;
+    }
+    words[w] = bits;
+  }
+#else
+  unsigned i;
+
+  for(w = 0; w * 64 < numInputs; w++){
+    bits = 0;
+    n = numInputs - w * 64 < 64 ? numInputs - w * 64 : 64;
+    for(i = 0; i < n; i++){
+      k = values[w * 64 + i] ^ '0';
+      if(k > 1)
+        return false;
+
+      bits |= (uint64_t) k << i;
+    }
+    words[w] = bits;
+  }
+#endif
+
+  return true;
+}
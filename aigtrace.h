@@ -0,0 +1,90 @@
+#ifndef AIGTRACE_H
+#define AIGTRACE_H
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include "aignode.h"
+
+#define TRACE_MAGIC "AIGTRACE"
+#define TRACE_VERSION 1
+#define TRACE_BLOCK_SIZE (1 << 20)
+#define TRACE_PADDING 64
+
+// Start of a packed trace, the rows follow.
+struct AigTraceHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t numInputs;
+  uint64_t numCycles;
+};
+
+// Packed input trace, mapped read only.  Each cycle is a row of 64 bit
+// words, input i is bit i % 64 of word i / 64 and unused bits are 0.
+class AigTrace {
+
+public:
+  AigTrace();
+  ~AigTrace();
+
+  bool open(const string &fileName);
+  bool attach(const void* data, size_t size);
+  bool isOpen(void) const;
+  void close(void);
+  const string& error(void) const;
+  static bool isPacked(const string &fileName);
+
+  unsigned numInputs(void) const;
+  uint64_t numCycles(void) const;
+  unsigned rowWords(void) const;
+  const uint64_t* row(uint64_t cycle) const;
+
+  // conversion from and to '0'/'1' text lines
+  static bool pack(const string &textFile, const string &packedFile, string &error);
+  static bool unpack(const string &packedFile, const string &textFile, string &error);
+
+private:
+  void* map;
+  size_t mapSize;
+  const AigTraceHeader* header;
+  const uint64_t* rows;
+  unsigned words;
+  string message;
+};
+
+// Text trace read in large blocks and packed into rows like a packed
+// trace.  Lines are the input values and one more character, the CR
+// before the LF; the first line of another length ends the trace.
+// Values are checked and packed 16 at a time with SSE2 where available.
+class AigTextTrace {
+
+public:
+  AigTextTrace();
+  ~AigTextTrace();
+
+  bool open(const string &fileName, unsigned numInputs);
+  void close(void);
+
+  // 1 with the next row, 0 at the end of the trace, -1 on an invalid
+  // value in line()
+  int next(const uint64_t* &row);
+  uint64_t line(void) const;
+
+private:
+  int fd;
+  bool eof;
+  unsigned numInputs;
+  uint64_t lineNo;
+
+  // block with padding for the last vector load, cur..end unread
+  vector<char> buffer;
+  char* cur;
+  char* end;
+  vector<uint64_t> words;
+
+  void fill(size_t need);
+  bool pack(const char* values);
+};
+
+#endif
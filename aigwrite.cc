@@ -0,0 +1,143 @@
+#include "aigwrite.h"
+
+AigWrite::AigWrite(AigDef &mgr, vector<AigNode*> &inputs, vector<AigNode*> &latches, vector<AigNode*> &latchLogic, vector<AigNode*> &outputs)
+  : mgr(mgr), inputs(inputs), latches(latches), latchLogic(latchLogic), outputs(outputs)
+{
+  out = NULL;
+  used = 0;
+}
+
+AigWrite::~AigWrite()
+{
+
+}
+
+// 'aig M I L O A', next states and outputs as text, then the ands as two
+// deltas each.  False if the stream fails.
+bool AigWrite::write(ostream &out){
+  unsigned i, lhs, ands, first;
+
+  number();
+
+  this->out = &out;
+  buffer.resize(WRITE_BUFFER_SIZE);
+  used = 0;
+
+  ands = rhs.size() / 2;
+  first = inputs.size() + latches.size() + 1;
+
+  put_string("aig ");
+  put_number(first - 1 + ands);
+  put(' ');
+  put_number(inputs.size());
+  put(' ');
+  put_number(latches.size());
+  put(' ');
+  put_number(outputs.size());
+  put(' ');
+  put_number(ands);
+  put('\n');
+
+  for(i = 0; i < latchLogic.size(); i++){
+    put_number(lits[latchLogic[i]->get_id()]);
+    put('\n');
+  }
+
+  for(i = 0; i < outputs.size(); i++){
+    put_number(lits[outputs[i]->get_id()]);
+    put('\n');
+  }
+
+  for(i = 0; i < ands; i++){
+    lhs = 2 * (first + i);
+    put_delta(lhs - rhs[2 * i]);
+    put_delta(rhs[2 * i] - rhs[2 * i + 1]);
+  }
+
+  flush();
+  out.flush();
+
+  return !out.fail();
+}
+
+// Literals in id order, which is topological.  Ands with a constant or
+// repeated fanin, like the inverters of complemented outputs, fold into a
+// fanin literal and get no variable.
+void AigWrite::number(void){
+  unsigned i, id, n, left, right;
+  AigNode* node;
+
+  mgr.buildFanout(inputs, latches, latchLogic, outputs);
+  n = mgr.numNodeIds();
+
+  lits.assign(n, 0);
+  rhs.clear();
+  lits[mgr.Zero()->get_id()] = 0;
+  lits[mgr.One()->get_id()] = 1;
+
+  for(i = 0; i < inputs.size(); i++)
+    lits[inputs[i]->get_id()] = 2 * (i + 1);
+
+  for(i = 0; i < latches.size(); i++)
+    lits[latches[i]->get_id()] = 2 * (inputs.size() + i + 1);
+
+  for(id = 0; id < n; id++){
+    node = mgr.idNode(id);
+    if(!node->is_and())
+      continue;
+
+    left = lits[node->get_left()->get_id()] ^ node->get_lpol();
+    right = lits[node->get_right()->get_id()] ^ node->get_rpol();
+
+    if(left == 0 || right == 0 || left == (right ^ 1))
+      lits[id] = 0;
+    else if(left == 1 || left == right)
+      lits[id] = right;
+    else if(right == 1)
+      lits[id] = left;
+    else{
+      lits[id] = 2 * (inputs.size() + latches.size() + rhs.size() / 2 + 1);
+      rhs.push_back(left > right ? left : right);
+      rhs.push_back(left > right ? right : left);
+    }
+  }
+}
+
+void AigWrite::put(char ch){
+  if(used == buffer.size())
+    flush();
+
+  buffer[used++] = ch;
+}
+
+void AigWrite::put_string(const char* str){
+  while(*str)
+    put(*str++);
+}
+
+void AigWrite::put_number(unsigned x){
+  char digits[16];
+  int n = 0;
+
+  do{
+    digits[n++] = '0' + x % 10;
+    x /= 10;
+  } while(x);
+
+  while(n)
+    put(digits[--n]);
+}
+
+// seven bits per byte, least significant first, high bit set if more follow
+void AigWrite::put_delta(unsigned x){
+  while(x & ~0x7f){
+    put((char) ((x & 0x7f) | 0x80));
+    x >>= 7;
+  }
+  put((char) x);
+}
+
+void AigWrite::flush(void){
+  out->write(&buffer[0], used);
+  used = 0;
+}
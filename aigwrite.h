@@ -0,0 +1,43 @@
+#ifndef AIGWRITE_H
+#define AIGWRITE_H
+
+#include <vector>
+#include <ostream>
+#include "aig.h"
+
+#define WRITE_BUFFER_SIZE (1 << 16)
+
+// Writes the current aig as binary aiger.  Inputs, latches and outputs
+// keep their order, ands are renumbered in topological order.
+class AigWrite {
+
+public:
+  AigWrite(AigDef &mgr, vector<AigNode*> &inputs, vector<AigNode*> &latches, vector<AigNode*> &latchLogic, vector<AigNode*> &outputs);
+  ~AigWrite();
+
+  bool write(ostream &out);
+
+private:
+  AigDef &mgr;
+  vector<AigNode*> &inputs;
+  vector<AigNode*> &latches;
+  vector<AigNode*> &latchLogic;
+  vector<AigNode*> &outputs;
+
+  // aiger literal by node id, ands as rhs0 >= rhs1 pairs
+  vector<unsigned> lits;
+  vector<unsigned> rhs;
+
+  ostream* out;
+  vector<char> buffer;
+  unsigned used;
+
+  void number(void);
+  void put(char ch);
+  void put_string(const char* str);
+  void put_number(unsigned x);
+  void put_delta(unsigned x);
+  void flush(void);
+};
+
+#endif
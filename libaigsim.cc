@@ -0,0 +1,202 @@
+#include <new>
+#include <cstring>
+#include "aig.h"
+#include "aigload.h"
+#include "aigopt.h"
+#include "aigprog.h"
+#include "aigsim.h"
+#include "libaigsim.h"
+
+// The values are kept a byte each, as the simulator steps them, and only
+// packed or unpacked at the calls.
+struct aigsim
+{
+  AigProgram program;
+  AigSim* sim;
+  vector<unsigned char> in;
+  mutable vector<unsigned char> state;
+  vector<unsigned char> out;
+
+  // a word per value
+  AigLaneSim* lanes;
+  vector<uint64_t> laneIn;
+  vector<uint64_t> laneState;
+  vector<uint64_t> laneOut;
+};
+
+static void set_error(char* error, size_t size, const char* message){
+  if(!error || !size)
+    return;
+
+  strncpy(error, message, size - 1);
+  error[size - 1] = 0;
+}
+
+static void pack(const unsigned char* values, unsigned n, uint64_t* words){
+  unsigned i;
+
+  memset(words, 0, AIGSIM_WORDS(n) * sizeof(uint64_t));
+  for(i = 0; i < n; i++)
+    words[i / 64] |= (uint64_t) values[i] << (i % 64);
+}
+
+static void unpack(const uint64_t* words, unsigned n, unsigned char* values){
+  unsigned i;
+
+  for(i = 0; i < n; i++)
+    values[i] = (words[i / 64] >> (i % 64)) & 1;
+}
+
+// Loads the file, or the image if fileName is NULL, with all outputs and
+// latches and compiles it.  The C interface must not throw.
+static aigsim* open_design(const char* fileName, const void* data, size_t dataSize, unsigned flags, char* error, size_t size){
+  bool loaded;
+  AigDef mgr;
+  vector<AigNode*> inputs;
+  vector<AigNode*> latches;
+  vector<AigNode*> latchLogic;
+  vector<AigNode*> outputs;
+  vector<string> observed;
+  aigsim* handle = NULL;
+
+  try{
+    AigLoad loader(mgr, inputs, latches, latchLogic, outputs);
+    if(fileName)
+      loaded = loader.load(fileName, observed, false);
+    else
+      loaded = loader.loadMemory((const char*) data, dataSize, observed, false);
+
+    if(!loaded){
+      set_error(error, size, loader.error().c_str());
+      return NULL;
+    }
+
+    mgr.clean();
+
+    if(flags & AIGSIM_OPTIMIZE){
+      AigOpt opt(mgr, inputs, latches, latchLogic, outputs);
+      opt.optimize(false, false);
+    }
+
+    handle = new aigsim;
+    handle->sim = NULL;
+    handle->lanes = NULL;
+    handle->program.compile(mgr, inputs, latches, latchLogic, outputs);
+    handle->sim = new AigSim(handle->program);
+    handle->in.assign(handle->program.numInputs() + 1, 0);
+    handle->state.assign(handle->program.numLatches() + 1, 0);
+    handle->out.assign(handle->program.numOutputs() + 1, 0);
+    handle->lanes = new AigLaneSim(handle->program);
+    handle->laneIn.assign(handle->program.numInputs() + 1, 0);
+    handle->laneState.assign(handle->program.numLatches() + 1, 0);
+    handle->laneOut.assign(handle->program.numOutputs() + 1, 0);
+  }
+  catch(bad_alloc&){
+    aigsim_close(handle);
+    set_error(error, size, "out of memory");
+    return NULL;
+  }
+
+  return handle;
+}
+
+aigsim* aigsim_open_file(const char* file_name, unsigned flags, char* error, size_t size){
+  return open_design(file_name, NULL, 0, flags, error, size);
+}
+
+aigsim* aigsim_open_memory(const void* data, size_t data_size, unsigned flags, char* error, size_t size){
+  return open_design(NULL, data, data_size, flags, error, size);
+}
+
+void aigsim_close(aigsim* handle){
+  if(!handle)
+    return;
+
+  delete handle->sim;
+  delete handle->lanes;
+  delete handle;
+}
+
+unsigned aigsim_num_inputs(const aigsim* handle){
+  return handle->program.numInputs();
+}
+
+unsigned aigsim_num_latches(const aigsim* handle){
+  return handle->program.numLatches();
+}
+
+unsigned aigsim_num_outputs(const aigsim* handle){
+  return handle->program.numOutputs();
+}
+
+void aigsim_reset(aigsim* handle){
+  handle->sim->reset();
+  memset(&handle->in[0], 0, handle->in.size());
+  memset(&handle->out[0], 0, handle->out.size());
+  handle->lanes->reset();
+  memset(&handle->laneIn[0], 0, handle->laneIn.size() * sizeof(uint64_t));
+  memset(&handle->laneOut[0], 0, handle->laneOut.size() * sizeof(uint64_t));
+}
+
+void aigsim_set_inputs(aigsim* handle, const uint64_t* inputs){
+  unpack(inputs, handle->program.numInputs(), &handle->in[0]);
+}
+
+void aigsim_step(aigsim* handle, uint64_t cycles){
+  uint64_t c;
+
+  for(c = 0; c < cycles; c++)
+    handle->sim->step(&handle->in[0], &handle->state[0], &handle->out[0]);
+}
+
+void aigsim_run(aigsim* handle, const uint64_t* inputs, uint64_t cycles, uint64_t* outputs, uint64_t* latches){
+  uint64_t c;
+  unsigned numInputs = handle->program.numInputs();
+  unsigned numLatches = handle->program.numLatches();
+  unsigned numOutputs = handle->program.numOutputs();
+  unsigned char* in = &handle->in[0];
+  unsigned char* state = &handle->state[0];
+  unsigned char* out = &handle->out[0];
+
+  for(c = 0; c < cycles; c++){
+    unpack(inputs, numInputs, in);
+    handle->sim->step(in, state, out);
+    pack(out, numOutputs, outputs);
+
+    if(latches){
+      pack(state, numLatches, latches);
+      latches += AIGSIM_WORDS(numLatches);
+    }
+
+    inputs += AIGSIM_WORDS(numInputs);
+    outputs += AIGSIM_WORDS(numOutputs);
+  }
+}
+
+void aigsim_get_latches(const aigsim* handle, uint64_t* latches){
+  handle->sim->latchValues(&handle->state[0]);
+  pack(&handle->state[0], handle->program.numLatches(), latches);
+}
+
+void aigsim_get_outputs(const aigsim* handle, uint64_t* outputs){
+  pack(&handle->out[0], handle->program.numOutputs(), outputs);
+}
+
+void aigsim_set_lane_inputs(aigsim* handle, const uint64_t* inputs){
+  memcpy(&handle->laneIn[0], inputs, handle->program.numInputs() * sizeof(uint64_t));
+}
+
+void aigsim_step_lanes(aigsim* handle, uint64_t cycles){
+  uint64_t c;
+
+  for(c = 0; c < cycles; c++)
+    handle->lanes->step(&handle->laneIn[0], &handle->laneState[0], &handle->laneOut[0]);
+}
+
+void aigsim_get_lane_latches(const aigsim* handle, uint64_t* latches){
+  handle->lanes->latchValues(latches);
+}
+
+void aigsim_get_lane_outputs(const aigsim* handle, uint64_t* outputs){
+  memcpy(outputs, &handle->laneOut[0], handle->program.numOutputs() * sizeof(uint64_t));
+}
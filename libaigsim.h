@@ -0,0 +1,163 @@
+/*------------------------------------------------------------------------*/
+/* API of 'libaigsim', the cycle simulator of 'sim' for use in other
+ * programs.  A design is loaded from an aiger file or its image in memory
+ * and compiled once.  Inputs, latches and outputs are passed as packed
+ * words: value i is bit i % 64 of word i / 64, as in packed traces.
+ * Stepping and reading values neither allocate nor do any I/O.
+ *
+ * All latches and outputs of the file are kept, in file order.  Latches
+ * start at 0.  A handle must not be used by two threads at once, separate
+ * handles are independent.
+ */
+#ifndef libaigsim_h_INCLUDED
+#define libaigsim_h_INCLUDED
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define AIGSIM_VERSION 1
+
+/* packed words of n values */
+#define AIGSIM_WORDS(n) (((n) + 63) / 64)
+
+/* load flags */
+#define AIGSIM_OPTIMIZE 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct aigsim aigsim;
+
+/*------------------------------------------------------------------------*/
+/* Load and compile a design, .gz files are decompressed.  Returns 0 on
+ * failure with the message copied to 'error' if it is not 0, truncated to
+ * 'size' bytes.
+ */
+aigsim *aigsim_open_file (const char *file_name, unsigned flags,
+                          char *error, size_t size);
+
+/* Same for 'data_size' bytes of an uncompressed aiger file at 'data'.
+ * The data is no longer needed when the call returns.
+ */
+aigsim *aigsim_open_memory (const void *data, size_t data_size,
+                            unsigned flags, char *error, size_t size);
+
+void aigsim_close (aigsim *);
+
+/*------------------------------------------------------------------------*/
+
+unsigned aigsim_num_inputs (const aigsim *);
+unsigned aigsim_num_latches (const aigsim *);
+unsigned aigsim_num_outputs (const aigsim *);
+
+/*------------------------------------------------------------------------*/
+/* Latches, inputs and outputs back to 0.
+ */
+void aigsim_reset (aigsim *);
+
+/* Inputs of the following steps, AIGSIM_WORDS (num_inputs) words.  Bits
+ * beyond the last input are ignored.
+ */
+void aigsim_set_inputs (aigsim *, const uint64_t *inputs);
+
+/* Each cycle updates the latches from the current inputs and latches and
+ * takes the outputs with the new latch values, as a row of 'sim' output.
+ */
+void aigsim_step (aigsim *, uint64_t cycles);
+
+/* Steps 'cycles' cycles without returning in between.  Row c of 'inputs'
+ * holds the inputs of cycle c in AIGSIM_WORDS (num_inputs) words, row c of
+ * 'outputs' gets its outputs in AIGSIM_WORDS (num_outputs) words.  Unless
+ * 'latches' is 0 row c of it gets the latch values cycle c started with,
+ * in AIGSIM_WORDS (num_latches) words.  The last row stays the current
+ * inputs.
+ */
+void aigsim_run (aigsim *, const uint64_t *inputs, uint64_t cycles,
+                 uint64_t *outputs, uint64_t *latches);
+
+/* Current latch values and the outputs of the last step into
+ * AIGSIM_WORDS (num_latches) and AIGSIM_WORDS (num_outputs) words, bits
+ * beyond the last one are 0.
+ */
+void aigsim_get_latches (const aigsim *, uint64_t *latches);
+void aigsim_get_outputs (const aigsim *, uint64_t *outputs);
+
+/*------------------------------------------------------------------------*/
+/* Pattern parallel simulation of AIGSIM_LANES independent runs, one per
+ * bit of a word.  A value is a whole word here: bit k of it belongs to
+ * lane k.  The lanes have their own latches, inputs and outputs, separate
+ * from those above, and are reset by 'aigsim_reset' too.
+ */
+#define AIGSIM_LANES 64
+
+/* num_inputs words */
+void aigsim_set_lane_inputs (aigsim *, const uint64_t *inputs);
+
+void aigsim_step_lanes (aigsim *, uint64_t cycles);
+
+/* num_latches and num_outputs words */
+void aigsim_get_lane_latches (const aigsim *, uint64_t *latches);
+void aigsim_get_lane_outputs (const aigsim *, uint64_t *outputs);
+
+#ifdef __cplusplus
+}
+
+/*------------------------------------------------------------------------*/
+/* Owner of a handle.  load() returns false with error() set on failure.
+ */
+class AigModel {
+
+public:
+  AigModel() : handle(0) { message[0] = 0; }
+  ~AigModel() { aigsim_close(handle); }
+
+  bool load(const char* fileName, unsigned flags = 0){
+    aigsim_close(handle);
+    handle = aigsim_open_file(fileName, flags, message, sizeof(message));
+    return handle != 0;
+  }
+
+  bool load(const void* data, size_t size, unsigned flags = 0){
+    aigsim_close(handle);
+    handle = aigsim_open_memory(data, size, flags, message, sizeof(message));
+    return handle != 0;
+  }
+
+  bool isOpen(void) const { return handle != 0; }
+  const char* error(void) const { return message; }
+
+  unsigned numInputs(void) const { return aigsim_num_inputs(handle); }
+  unsigned numLatches(void) const { return aigsim_num_latches(handle); }
+  unsigned numOutputs(void) const { return aigsim_num_outputs(handle); }
+  unsigned inputWords(void) const { return AIGSIM_WORDS(numInputs()); }
+  unsigned latchWords(void) const { return AIGSIM_WORDS(numLatches()); }
+  unsigned outputWords(void) const { return AIGSIM_WORDS(numOutputs()); }
+
+  void reset(void){ aigsim_reset(handle); }
+  void setInputs(const uint64_t* inputs){ aigsim_set_inputs(handle, inputs); }
+  void step(uint64_t cycles = 1){ aigsim_step(handle, cycles); }
+  void run(const uint64_t* inputs, uint64_t cycles, uint64_t* outputs, uint64_t* latches = 0){
+    aigsim_run(handle, inputs, cycles, outputs, latches);
+  }
+  void latches(uint64_t* latches) const { aigsim_get_latches(handle, latches); }
+  void outputs(uint64_t* outputs) const { aigsim_get_outputs(handle, outputs); }
+
+  void setLaneInputs(const uint64_t* inputs){ aigsim_set_lane_inputs(handle, inputs); }
+  void stepLanes(uint64_t cycles = 1){ aigsim_step_lanes(handle, cycles); }
+  void laneLatches(uint64_t* latches) const { aigsim_get_lane_latches(handle, latches); }
+  void laneOutputs(uint64_t* outputs) const { aigsim_get_lane_outputs(handle, outputs); }
+
+  aigsim* get(void) const { return handle; }
+
+private:
+  aigsim* handle;
+  char message[128];
+
+  AigModel(const AigModel&);
+  AigModel& operator=(const AigModel&);
+};
+
+#endif
+
+#endif
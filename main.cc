@@ -2,178 +2,416 @@
 #include <fstream>
 #include <string>
 #include <cstring>
+#include <cctype>
+#include <cstdio>
+#include <climits>
+#include <cstdlib>
 #include <unistd.h>
 #include "aig.h"
-#include "aiger_cc.h"
-#include "hash_map.h"
+#include "aigopt.h"
+#include "aigsweep.h"
+#include "aigload.h"
+#include "aigwrite.h"
+#include "aigprog.h"
+#include "aigsim.h"
+#include "aigout.h"
+#include "aigserve.h"
+#include "aigstats.h"
+#include "aigref.h"
+#include "aigprof.h"
+
+// options that shape the simulation program
+struct PrepareOptions
+{
+  bool verbose;
+  bool optimize;
+  bool simulate;
+  int sweepCycles;
+  string mapFile;
+  string writeFile;
+  vector<string> observed;
+};
+
+// nodes the program was compiled from, for the engines that walk them
+struct PreparedDesign
+{
+  AigDef mgr;
+  vector<AigNode*> inputs;
+  vector<AigNode*> latches;
+  vector<AigNode*> latchLogic;
+  vector<AigNode*> outputs;
+  // outputs of the program and their positions in the file
+  vector<AigNode*> observed;
+  vector<unsigned> positions;
+  AigLoad loader;
+
+  PreparedDesign() : loader(mgr, inputs, latches, latchLogic, outputs) {}
+};
+
+// Loads, reduces and compiles src, or maps the program from the cache
+// file if it was built from the same src and options.  False if there is
+// nothing to simulate, with -w only.  Errors end the program.  Unless
+// stats is NULL each step is timed as a phase of it.  Unless design is
+// NULL the nodes are kept in it and the cache is only written.
+static bool prepare(const string &aigerFile, const string &cacheFile, const PrepareOptions &opt, AigProgram &program, AigStats* stats, PreparedDesign* design){
+  bool verbose = opt.verbose;
+  bool optimize = opt.optimize;
+  bool in = opt.simulate;
+  bool cached = false;
+  int sweepCycles = opt.sweepCycles;
+  const string &mapFile = opt.mapFile;
+  const string &writeFile = opt.writeFile;
+  vector<string> observed = opt.observed;
+  string options;
+  uint64_t key = 0;
+  char number[16];
+  PreparedDesign local;
+  PreparedDesign &d = design ? *design : local;
+  AigDef &mgr = d.mgr;
+  vector<AigNode*> &inputs = d.inputs;
+  vector<AigNode*> &latches = d.latches;
+  vector<AigNode*> &latchLogic = d.latchLogic;
+  vector<AigNode*> &outputs = d.outputs;
+  vector<AigNode*> &observedNodes = d.observed;
+
+  // the program depends on the source and the options that reduce it
+  if(!cacheFile.empty()){
+    if(stats)
+      stats->begin("cache");
+
+    sprintf(number, "S%d", sweepCycles);
+    options = optimize ? "O\n" : "";
+    options += number;
+    for(unsigned i = 0; i < observed.size(); i++)
+      options += "\no" + observed[i];
+
+    // a missing src is reported by the loader, -w and the map of -S are
+    // only made by a full run
+    key = AigProgram::sourceKey(aigerFile, options);
+    if(key && writeFile.empty() && !sweepCycles && !design && program.load(cacheFile, key))
+      cached = true;
+
+    if(verbose)
+      cout << " *** cache " << cacheFile << (cached ? " hit" : " miss") << endl;
+  }
 
-typedef hash_map<const unsigned, aiger_and*, hash<unsigned>, eqNode> AndMap;
+  if(cached)
+    return true;
 
-unsigned aiger_literal(unsigned lit)
-{
-  return (lit/2) * 2;
-}
+  if(verbose)
+    cout << " *** loading aig" << endl;
 
-unsigned aig_index(unsigned lit)
-{
-  return (lit/2);
-}
+  AigLoad &loader = d.loader;
+  loader.setStats(stats);
+  if(!loader.load(aigerFile.c_str(), observed, verbose)){
+    cerr << "*** [aigtoaig] " << loader.error() << endl;
+    exit(1);
+  }
 
-bool polarity(unsigned lit)
-{
-  unsigned index = lit/2;
+  AigNode* f = outputs.empty() ? NULL : outputs.back();
 
-  if((index*2) == lit)
-    return false;
-  else
-    return true;
-}
+  if(verbose)
+    cout << endl << " *** cleaning up nodes" << endl;
 
-void traverse_nodes(AigDef& mgr, NodeMap& aigNodes, AndMap& aigerAndNodes, aiger_and* createNode){
-  unsigned index;
-  bool rpol, lpol;
-  AigNode* left;
-  AigNode* right;
-
-  //check if node has already been created
-  index = aig_index(createNode->lhs);
-  if(aigNodes[index] != NULL)
-    return;
-
-  index = aig_index(createNode->rhs0);
-  left = aigNodes[index];
-  if(left == NULL){
-    index = aiger_literal(createNode->rhs0);
-    traverse_nodes(mgr, aigNodes, aigerAndNodes, aigerAndNodes[index]);
-
-    index = aig_index(createNode->rhs0);
-    left = aigNodes[index];
-    if(left == NULL){
-      cerr << "left == null " << index << endl;
-      exit(1);
+  if(stats){
+    stats->count("aiger_bytes", (uint64_t) loader.memoryUse().bytes);
+    stats->count("aiger_max_bytes", (uint64_t) loader.memoryUse().max);
+    stats->count("loaded_ands", loader.numAnds());
+    stats->begin("clean");
+  }
+
+  mgr.clean();
+
+  if(sweepCycles){
+    if(verbose)
+      cout << " *** sweeping equivalent latches and nodes" << endl;
+
+    if(stats)
+      stats->begin("sweep");
+
+    AigSweep sweep(mgr, inputs, latches, latchLogic, outputs);
+    sweep.sweep(sweepCycles, verbose);
+
+    if(mapFile.empty())
+      sweep.writeMap(cout);
+    else{
+      ofstream map(mapFile.c_str());
+      if(!map.is_open()){
+        cerr << "Unable to open file " << mapFile << endl;
+        exit(1);
+      }
+      sweep.writeMap(map);
     }
+
+    if(!outputs.empty())
+      f = outputs.back();
   }
-  lpol = polarity(createNode->rhs0);
-
-  index = aig_index(createNode->rhs1);
-  right = aigNodes[index];
-  if(right == NULL){
-    index = aiger_literal(createNode->rhs1);
-    traverse_nodes(mgr, aigNodes, aigerAndNodes, aigerAndNodes[index]);
-
-    index = aig_index(createNode->rhs1);
-    right = aigNodes[index];
-    if(right == NULL){
-      cerr << "right == null " << index << endl;
+
+  if(optimize){
+    if(verbose)
+      cout << " *** optimizing aig" << endl;
+
+    if(stats)
+      stats->begin("optimize");
+
+    AigOpt opt(mgr, inputs, latches, latchLogic, outputs);
+    opt.optimize(verbose, true);
+
+    if(!outputs.empty())
+      f = outputs.back();
+  }
+
+  if(!writeFile.empty()){
+    if(verbose)
+      cout << " *** writing " << writeFile << endl;
+
+    if(stats)
+      stats->begin("write");
+
+    ofstream aig(writeFile.c_str(), ios::out | ios::binary);
+    if(!aig.is_open()){
+      cerr << "Unable to open file " << writeFile << endl;
       exit(1);
     }
+
+    AigWrite writer(mgr, inputs, latches, latchLogic, outputs);
+    bool written = writer.write(aig);
+    aig.close();
+    if(!written || aig.fail()){
+      cerr << "Unable to write file " << writeFile << endl;
+      exit(1);
+    }
+
+    if(!in)
+      return false;
   }
-  rpol = polarity(createNode->rhs1);
 
-  index = aig_index(createNode->lhs);
-  aigNodes[index] = mgr.NewAndNode(left, lpol, right, rpol, index);
-}
+  // without -o only the last output is observed
+  if(observed.empty()){
+    observedNodes.push_back(f);
+    if(f)
+      d.positions.push_back(loader.outputPositions().back());
+  }
+  else{
+    observedNodes = outputs;
+    d.positions = loader.outputPositions();
+  }
 
-AigNode* aiger_to_aig(AigDef &mgr, aiger* aiger, vector<AigNode*> &latches, vector<AigNode*> &inputs, vector<AigNode*> &latchLogic, bool verbose){
-  unsigned i, index, latchNext;
-  bool lpol, rpol;
-  AigNode* left;
-  AigNode* right;
-  AigNode* next;
-  AigNode* latch;
-  AigNode* f;
-  NodeMap aigNodes;
-  AndMap aigerAndNodes;
+  if(!observedNodes.back()){
+    cerr << "[main.cc main] NULL function node" << endl;
+    exit(1);
+  }
 
   if(verbose)
-    cout << "     * creating " << aiger->num_inputs << " input nodes" << endl;
-
-  // create primary inputs
-  for(i=0; i<aiger->num_inputs; i++){
-    index = aig_index(aiger->inputs[i].lit);
-    f = mgr.NewInputNode(index);
-    aigNodes[index] = f;
-//    inputs[f->get_index()] = f;
-    inputs.push_back(f);
-  }
+    cout << " *** compiling simulation program" << endl;
+
+  if(stats)
+    stats->begin("compile");
+
+  program.compile(mgr, inputs, latches, latchLogic, observedNodes);
 
   if(verbose)
-    cout << "     * storing aiger and nodes" << endl;
+    cout << "     * " << program.numAnds() << " ands, " << program.numLevels() << " levels, " << program.numOutputs() << " outputs" << endl;
+
+  if(key && !program.save(cacheFile, key))
+    cerr << "Unable to write cache file " << cacheFile << endl;
+
+  return true;
+}
+
+// relative paths are sent to the server from the current directory
+static string absolute(const string &path){
+  char buffer[PATH_MAX];
+
+  if(path.empty() || path[0] == '/' || !getcwd(buffer, sizeof(buffer)))
+    return path;
+
+  return string(buffer) + "/" + path;
+}
 
-  // store aiger 'and' node in hashmap
-  for(i=0; i<aiger->num_ands; i++){
-    aigerAndNodes[aiger->ands[i].lhs] = &(aiger->ands[i]);
+// Runs one job on a server, dst "-" returns the output to stdout.  With
+// inline the packed trace is sent instead of its path.
+static void submit(const string &socketPath, AigJobHeader &job, const string &aigerFile, const string &outputFile, const string &inputFile, bool inlineTrace){
+  char path[PATH_MAX];
+  string design, error, message;
+  vector<uint64_t> stimulus;
+  vector<char> result;
+  AigReplyHeader reply;
+
+  design = realpath(aigerFile.c_str(), path) ? path : aigerFile;
+  job.stimulusSize = 0;
+
+  if(inlineTrace){
+    if(!AigTrace::isPacked(inputFile)){
+      cerr << "Inline stimulus needs a packed trace " << inputFile << endl;
+      exit(1);
+    }
+
+    ifstream trace(inputFile.c_str(), ios::in | ios::binary);
+    trace.seekg(0, ios::end);
+    job.stimulusSize = trace.tellg();
+    trace.seekg(0, ios::beg);
+    stimulus.resize(job.stimulusSize / sizeof(uint64_t) + 1);
+    trace.read((char*) &stimulus[0], job.stimulusSize);
   }
 
-  if(verbose)
-    cout << endl << "     * creating " << aiger->num_latches << " latch nodes" << endl;
-
-  // create latch nodes
-  for(i=0; i<aiger->num_latches; i++){
-    index = aig_index(aiger->latches[i].lit);
-    f = mgr.NewLatchNode(index);
-    aigNodes[index] = f;
-//    latches[f->get_index()] = f;
-    latches.push_back(f);
+  if(!AigServer::request(socketPath, job, design, inlineTrace ? string() : absolute(inputFile), outputFile == "-" ? string() : absolute(outputFile), stimulus, reply, message, result, error)){
+    cerr << error << endl;
+    exit(1);
   }
 
-  if(verbose)
-    cout << "     * creating " << aigerAndNodes.size() << " and nodes" << endl;
-
-  // traverse and create aig 'and' nodes
-  AndMap::iterator it = aigerAndNodes.begin();
-  for (; it != aigerAndNodes.end(); ++it){
-    //check if node has been created
-    index = aig_index(it->first);
-    if(aigNodes[index] == NULL)
-      traverse_nodes(mgr, aigNodes, aigerAndNodes, it->second);
+  if(!result.empty())
+    cout.write(&result[0], result.size());
+
+  if(reply.status){
+    cerr << message << endl;
+    exit(1);
   }
+}
 
-  if(verbose)
-    cout << "     * creating " << aiger->num_outputs << " output nodes" << endl;
+// engines of --engine, the reference one walks the nodes
+enum Engine { ENGINE_COMPILED, ENGINE_LANES, ENGINE_RECURSIVE };
+
+static const char* engineNames[] = { "compiled", "lanes", "recursive", NULL };
+
+// Every latch and output the engine and the reference disagree on in
+// the cycle, with the inputs and both full rows.  The cycle counts from
+// 0, it is reported as the row of the trace, from 1 like its lines.
+static void report_mismatch(PreparedDesign &design, uint64_t cycle, Engine engine, const vector<unsigned char> &in, const vector<unsigned char> &state, const vector<unsigned char> &out, const vector<unsigned char> &refState, const vector<unsigned char> &refOut){
+  unsigned i, numInputs = design.inputs.size(), numLatches = design.latches.size(), numOutputs = design.observed.size();
+  const char* name;
+  AigSymbols &syms = design.loader.symbols();
+
+  cerr << "Cross check failed on row " << cycle + 1 << " of the trace, " << engineNames[engine] << " engine against the reference" << endl;
+
+  cerr << "  inputs    ";
+  for(i = 0; i < numInputs; i++)
+    cerr << (int) in[i];
+  cerr << endl << "  latches   ";
+  for(i = 0; i < numLatches; i++)
+    cerr << (int) state[i];
+  cerr << endl << "  reference ";
+  for(i = 0; i < numLatches; i++)
+    cerr << (int) refState[i];
+  cerr << endl << "  outputs   ";
+  for(i = 0; i < numOutputs; i++)
+    cerr << (int) out[i];
+  cerr << endl << "  reference ";
+  for(i = 0; i < numOutputs; i++)
+    cerr << (int) refOut[i];
+  cerr << endl;
+
+  for(i = 0; i < numLatches; i++)
+    if(state[i] != refState[i]){
+      name = syms.litName(2 * design.latches[i]->get_index());
+      cerr << "  latch " << i << " lit " << 2 * design.latches[i]->get_index() << (name ? " " : "") << (name ? name : "")
+           << ": " << (int) state[i] << ", reference " << (int) refState[i] << endl;
+    }
 
-  // create output nodes
-  for(i=0; i<aiger->num_outputs; i++){
-    index = aig_index(aiger->outputs[i].lit);
-    lpol = polarity(aiger->outputs[i].lit);
+  for(i = 0; i < numOutputs; i++)
+    if(out[i] != refOut[i]){
+      name = i < design.positions.size() ? syms.outputName(design.positions[i]) : NULL;
+      cerr << "  output " << (i < design.positions.size() ? design.positions[i] : i) << (name ? " " : "") << (name ? name : "")
+           << ": " << (int) out[i] << ", reference " << (int) refOut[i] << endl;
+    }
+}
 
-    left = aigNodes[index];
+// Simulates the trace into dst on one thread with the engine, same output
+// as AigSim::run.  With crossCheck the reference engine runs in lock-step
+// and the first cycle they differ in ends the program.  The walks of the
+// recursive engine are counted into profile unless it is NULL.  Errors
+// end the program.  Returns the cycles simulated, evaluations gets the
+// ands the engine evaluated.
+static uint64_t run_engine(PreparedDesign &design, const AigProgram &program, Engine engine, bool crossCheck, const string &inputFile, const string &outputFile, bool packedOutput, unsigned columns, AigProfile* profile, uint64_t &evaluations){
+  unsigned i, numInputs = program.numInputs(), numLatches = program.numLatches(), numOutputs = program.numOutputs();
+  int status = 1;
+  uint64_t cycles = 0;
+  const uint64_t* row;
+  string error;
+  AigTrace trace;
+  AigTextTrace text;
+  AigOutput dst;
+  AigSim simulator(program);
+  // only the engine asked for and the checker are built
+  AigLaneSim* lanes = engine == ENGINE_LANES ? new AigLaneSim(program) : NULL;
+  AigRefSim* ref = engine == ENGINE_RECURSIVE ? new AigRefSim(design.mgr, design.inputs, design.latches, design.latchLogic, design.observed) : NULL;
+  AigRefSim* check = crossCheck ? new AigRefSim(design.mgr, design.inputs, design.latches, design.latchLogic, design.observed) : NULL;
+  vector<unsigned char> in(numInputs + 1), state(numLatches + 1), out(numOutputs + 1);
+  vector<unsigned char> refState(numLatches + 1), refOut(numOutputs + 1);
+  vector<uint64_t> laneIn(numInputs + 1), laneState(numLatches + 1), laneOut(numOutputs + 1);
+
+  if(!simulator.openTrace(inputFile, text, trace, error)){
+    cerr << error << endl;
+    exit(1);
+  }
 
-    if(lpol)
-      f = mgr.NewAndNode(left, lpol, mgr.One(), false);
-    else
-      f = left;
+  if(trace.isOpen() && trace.numInputs() != numInputs){
+    cerr << "Trace has " << trace.numInputs() << " inputs, the aig " << numInputs << endl;
+    exit(1);
   }
 
-  //TODO map latch node to logic cone and create next state var
-  for(i=0; i<aiger->num_latches; i++){
-    index = aig_index(aiger->latches[i].lit);
-    latch = aigNodes[index];
+  if(!dst.open(outputFile, packedOutput, columns, numInputs, numLatches, numOutputs)){
+    cerr << dst.error() << endl;
+    exit(1);
+  }
 
-    if(aiger->latches[i].next == 1){
-      rpol = false;
-      right = mgr.One();
+  simulator.reset();
+  if(ref)
+    ref->setProfile(profile);
+
+  while(trace.isOpen() ? cycles < trace.numCycles() : (status = text.next(row)) > 0){
+    if(trace.isOpen())
+      row = trace.row(cycles);
+    for(i = 0; i < numInputs; i++)
+      in[i] = (row[i / 64] >> (i % 64)) & 1;
+
+    // all lanes get the inputs, lane 0 is read
+    if(engine == ENGINE_LANES){
+      for(i = 0; i < numInputs; i++)
+        laneIn[i] = -(uint64_t) in[i];
+      lanes->step(&laneIn[0], &laneState[0], &laneOut[0]);
+      for(i = 0; i < numLatches; i++)
+        state[i] = laneState[i] & 1;
+      for(i = 0; i < numOutputs; i++)
+        out[i] = laneOut[i] & 1;
     }
-    else if(aiger->latches[i].next == 0){
-      rpol = false;
-      right = mgr.Zero();
-    }
-    else{
-      latchNext = aig_index(aiger->latches[i].next);
-      rpol = polarity(aiger->latches[i].next);
-      right = aigNodes[latchNext];
+    else if(engine == ENGINE_RECURSIVE)
+      ref->step(&in[0], &state[0], &out[0]);
+    else
+      simulator.step(&in[0], &state[0], &out[0]);
+
+    dst.write(&in[0], &state[0], &out[0]);
+
+    if(crossCheck){
+      check->step(&in[0], &refState[0], &refOut[0]);
+      if(memcmp(&state[0], &refState[0], numLatches) || memcmp(&out[0], &refOut[0], numOutputs)){
+        dst.close();
+        report_mismatch(design, cycles, engine, in, state, out, refState, refOut);
+        exit(1);
+      }
     }
 
-    AigNode* logicCone;
-    if(rpol)
-      logicCone = mgr.NewAndNode(right, rpol, mgr.One(), false);
-    else
-      logicCone = right;
+    cycles++;
+  }
+
+  if(status < 0){
+    cerr << "Invalid input value on line " << text.line() << endl;
+    dst.close();
+    exit(1);
+  }
 
-    latchLogic.push_back(logicCone);
+  if(!dst.close()){
+    cerr << dst.error() << endl;
+    exit(1);
   }
 
-  return f;
+  evaluations = ref ? ref->evaluations() : cycles * (program.numAnds() + program.numCone());
+
+  delete lanes;
+  delete ref;
+  delete check;
+
+  return cycles;
 }
 
 int main(int argc, char *argv[])
@@ -183,15 +421,52 @@ int main(int argc, char *argv[])
   bool in = false;
   bool cycles = false;
   bool verbose = false;
+  bool optimize = false;
+  bool sweepArg = false;
+  bool mapArg = false;
+  bool outputArg = false;
+  bool writeArg = false;
+  bool cacheArg = false;
+  bool columnArg = false;
+  bool blockArg = false;
+  bool packedOutput = false;
+  bool limit = false;
+  bool socketArg = false;
+  bool workerArg = false;
+  bool serve = false;
+  bool stopServer = false;
+  bool inlineTrace = false;
+  bool statsArg = false;
+  bool countersArg = false;
+  bool profileArg = false;
+  bool engineArg = false;
+  bool crossCheck = false;
+  Engine engine = ENGINE_COMPILED;
+  bool usage;
+  int sweepCycles = 0;
+  unsigned k;
   int iterations = 10000;
+  unsigned columns = COLUMN_ALL;
+  // overlapping I/O only pays with more than one processor
+  int blockCycles = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? PIPE_BLOCK_CYCLES : 0;
+  int workers = sysconf(_SC_NPROCESSORS_ONLN) > 0 ? sysconf(_SC_NPROCESSORS_ONLN) : 1;
   string aigerFile;
   string outputFile;
   string inputFile;
-  aiger* aiger;
-  AigDef mgr;
-  vector<AigNode*> inputs;
-  vector<AigNode*> latches;
-  vector<AigNode*> latchLogic;
+  string mapFile;
+  string writeFile;
+  string cacheFile;
+  string socketPath;
+  string statsFile;
+  string profileFile;
+  char number[16];
+  char path[PATH_MAX];
+  vector<string> observed;
+  vector<string> args;
+  vector<string> designs;
+  PrepareOptions prepareOptions;
+  AigJobHeader job;
+  AigProgram program;
 
   for (int i = 1; i < argc; i++)
   {
@@ -203,6 +478,61 @@ int main(int argc, char *argv[])
         exit (1);
       }
       cycles = false;
+      limit = true;
+    }
+    else if(sweepArg){
+      sweepCycles = atoi(argv[i]);
+
+      if(sweepCycles <= 0){
+        cerr << USAGE << endl;
+        exit (1);
+      }
+      sweepArg = false;
+    }
+    else if(mapArg){
+      mapFile = argv[i];
+      mapArg = false;
+    }
+    else if(outputArg){
+      observed.push_back(argv[i]);
+      outputArg = false;
+    }
+    else if(writeArg){
+      writeFile = argv[i];
+      writeArg = false;
+    }
+    else if(cacheArg){
+      cacheFile = argv[i];
+      cacheArg = false;
+    }
+    else if(blockArg){
+      blockCycles = atoi(argv[i]);
+
+      if(blockCycles < 0 || !isdigit(argv[i][0])){
+        cerr << USAGE << endl;
+        exit (1);
+      }
+      blockArg = false;
+    }
+    else if(socketArg){
+      socketPath = argv[i];
+      socketArg = false;
+    }
+    else if(workerArg){
+      workers = atoi(argv[i]);
+
+      if(workers < 0 || !isdigit(argv[i][0])){
+        cerr << USAGE << endl;
+        exit (1);
+      }
+      workerArg = false;
+    }
+    else if(columnArg){
+      if(!AigOutput::parseColumns(argv[i], columns)){
+        cerr << USAGE << endl;
+        exit (1);
+      }
+      columnArg = false;
     }
     else if (!strcmp (argv[i], "-h"))
     {
@@ -213,56 +543,230 @@ int main(int argc, char *argv[])
       verbose = true;
     else if(!strcmp(argv[i], "-c"))
       cycles = true;
-    else if (argv[i][0] == '-'){
-      cerr << "[main.cc main] invalid command line option " << argv[i] << endl;
-      cerr << USAGE << endl;
-      exit (1);
+    else if(!strcmp(argv[i], "-O"))
+      optimize = true;
+    else if(!strcmp(argv[i], "-S"))
+      sweepArg = true;
+    else if(!strcmp(argv[i], "-m"))
+      mapArg = true;
+    else if(!strcmp(argv[i], "-o"))
+      outputArg = true;
+    else if(!strcmp(argv[i], "-w"))
+      writeArg = true;
+    else if(!strcmp(argv[i], "-C"))
+      cacheArg = true;
+    else if(!strcmp(argv[i], "-b"))
+      packedOutput = true;
+    else if(!strcmp(argv[i], "-e"))
+      columnArg = true;
+    else if(!strcmp(argv[i], "-B"))
+      blockArg = true;
+    else if(!strcmp(argv[i], "-D")){
+      socketArg = true;
+      serve = true;
     }
-    else if (!src){
-      aigerFile = argv[i];
-      src = true;
+    else if(!strcmp(argv[i], "-J"))
+      socketArg = true;
+    else if(!strcmp(argv[i], "-j"))
+      workerArg = true;
+    else if(!strcmp(argv[i], "-I"))
+      inlineTrace = true;
+    else if(!strcmp(argv[i], "-K"))
+      stopServer = true;
+    else if(!strcmp(argv[i], "--stats"))
+      statsArg = true;
+    else if(!strncmp(argv[i], "--stats=", 8) && argv[i][8]){
+      statsArg = true;
+      statsFile = argv[i] + 8;
     }
-    else if(!dst){
-      outputFile = argv[i];
-      dst = true;
+    else if(!strcmp(argv[i], "--counters"))
+      countersArg = statsArg = true;
+    else if(!strncmp(argv[i], "--engine=", 9)){
+      for(k = 0; engineNames[k] && strcmp(engineNames[k], argv[i] + 9); k++)
+        ;
+      if(!engineNames[k]){
+        cerr << "[main.cc main] unknown engine " << argv[i] + 9 << endl;
+        exit (1);
+      }
+      engine = (Engine) k;
+      engineArg = true;
     }
-    else if(!in){
-      inputFile = argv[i];
-      in = true;
+    else if(!strcmp(argv[i], "--cross-check"))
+      crossCheck = true;
+    else if(!strcmp(argv[i], "--profile"))
+      profileArg = true;
+    else if(!strncmp(argv[i], "--profile=", 10) && argv[i][10]){
+      profileArg = true;
+      profileFile = argv[i] + 10;
     }
-    else{
+    else if (argv[i][0] == '-' && argv[i][1]){
+      cerr << "[main.cc main] invalid command line option " << argv[i] << endl;
       cerr << USAGE << endl;
       exit (1);
     }
+    else
+      args.push_back(argv[i]);
   }
 
-  if(!in){
+  // a server takes any number of designs
+  if(serve)
+    designs = args;
+  else if(args.size() > 3){
     cerr << USAGE << endl;
     exit (1);
   }
+  else{
+    src = args.size() > 0;
+    dst = args.size() > 1;
+    in = args.size() > 2;
+    aigerFile = src ? args[0] : "";
+    outputFile = dst ? args[1] : "";
+    inputFile = in ? args[2] : "";
+  }
 
-  if(verbose)
-    cout << " *** creating aiger data structure" << endl;
+  // with -w the simulation is optional, a stop job needs no files
+  if(serve)
+    usage = designs.empty() || !writeFile.empty();
+  else if(!socketPath.empty())
+    usage = !in && !stopServer;
+  else
+    usage = !in && (writeFile.empty() || dst);
+
+  // stats, profiles and engines are of one local run, profiles of the
+  // recursive engine, which is the reference a cross check compares to
+  if((statsArg || profileArg || engineArg || crossCheck) && !socketPath.empty())
+    usage = true;
+  if(profileArg && engineArg && engine != ENGINE_RECURSIVE)
+    usage = true;
+  if(profileArg)
+    engine = ENGINE_RECURSIVE;
+  if(crossCheck && engine == ENGINE_RECURSIVE)
+    usage = true;
+
+  if(usage){
+    cerr << USAGE << endl;
+    exit (1);
+  }
 
-  aiger = read_aiger(aigerFile.c_str());
+  if(!socketPath.empty() && !serve){
+    job.kind = stopServer ? JOB_STOP : JOB_SIMULATE;
+    job.flags = packedOutput ? JOB_PACKED_OUTPUT : 0;
+    job.columns = columns;
+    job.cycleLimit = limit ? iterations : 0;
+    submit(socketPath, job, aigerFile, outputFile, inputFile, inlineTrace);
+    exit(0);
+  }
 
-  if(verbose)
-    cout << " *** converting aiger to aig" << endl;
+  prepareOptions.verbose = verbose;
+  prepareOptions.optimize = optimize;
+  prepareOptions.simulate = in || serve;
+  prepareOptions.sweepCycles = sweepCycles;
+  prepareOptions.mapFile = mapFile;
+  prepareOptions.writeFile = writeFile;
+  prepareOptions.observed = observed;
+
+  // with several designs each has its own cache file
+  if(serve){
+    AigServer server;
+    vector<AigProgram*> programs;
+
+    for(unsigned i = 0; i < designs.size(); i++){
+      if(verbose)
+        cout << " *** design " << designs[i] << endl;
+
+      sprintf(number, ".%u", i);
+      programs.push_back(new AigProgram);
+      prepare(designs[i], cacheFile.empty() || designs.size() == 1 ? cacheFile : cacheFile + number, prepareOptions, *programs.back(), NULL, NULL);
+      server.addDesign(realpath(designs[i].c_str(), path) ? path : designs[i], programs.back());
+    }
 
-  AigNode* f = aiger_to_aig(mgr, aiger, latches, inputs, latchLogic, verbose);
+    if(verbose)
+      cout << " *** serving on " << socketPath << endl;
 
-  if(verbose)
-    cout << endl << " *** cleaning up nodes" << endl;
+    if(!server.serve(socketPath, workers)){
+      cerr << server.error() << endl;
+      exit(1);
+    }
 
-  mgr.clean();
+    for(unsigned i = 0; i < programs.size(); i++)
+      delete programs[i];
+    exit(0);
+  }
 
-  if(verbose)
-    cout << " *** deleted aiger data structure" << endl << endl;
+  AigStats stats;
+  uint64_t simCycles = 0;
+  uint64_t evaluations = 0;
+  double simTime;
 
-  delete aiger;
+  // unavailable counters are reported, not an error
+  if(countersArg && !stats.openCounters() && verbose)
+    cout << " *** no hardware counters" << endl;
 
-  if(verbose)
-    cout << " *** sim" << endl;
+  // other engines run on one thread next to the nodes, they are kept
+  PreparedDesign* design = engine != ENGINE_COMPILED || crossCheck ? new PreparedDesign : NULL;
+  bool simulated = prepare(aigerFile, cacheFile, prepareOptions, program, statsArg ? &stats : NULL, design);
+
+  if(simulated && design){
+    if(verbose)
+      cout << " *** sim, " << engineNames[engine] << " engine" << (crossCheck ? " checked against the reference" : "") << endl;
+
+    AigProfile profile(design->mgr, design->latches, design->observed);
+
+    stats.begin("simulate");
+    simCycles = run_engine(*design, program, engine, crossCheck, inputFile, outputFile, packedOutput, columns, profileArg ? &profile : NULL, evaluations);
+    stats.end();
+
+    if(profileArg && profileFile.empty())
+      profile.write(cerr, design->loader.symbols(), design->positions, design->loader.outputLiterals());
+    else if(profileArg){
+      ofstream out(profileFile.c_str());
+      if(!out.is_open()){
+        cerr << "Unable to open file " << profileFile << endl;
+        exit(1);
+      }
+      profile.write(out, design->loader.symbols(), design->positions, design->loader.outputLiterals());
+    }
+  }
+  else if(simulated){
+    if(verbose)
+      cout << " *** sim" << endl;
+
+    stats.begin("simulate");
+    AigSim simulator(program);
+    simCycles = simulator.run(inputFile, outputFile, packedOutput, columns, blockCycles);
+    stats.end();
+  }
+  delete design;
+
+  if(!statsArg)
+    exit(0);
+
+  // a -w run without simulation has no program
+  if(simulated){
+    stats.count("inputs", program.numInputs());
+    stats.count("latches", program.numLatches());
+    stats.count("outputs", program.numOutputs());
+    stats.count("ands", program.numAnds());
+    stats.count("levels", program.numLevels());
+    if(engine == ENGINE_COMPILED && !crossCheck)
+      evaluations = simCycles * (program.numAnds() + program.numCone());
+  }
 
-  mgr.sim(f, latches, inputs, latchLogic, inputFile, outputFile);
-}
+  simTime = stats.wallTime("simulate");
+  stats.count("cycles", simCycles);
+  stats.rate("cycles_per_s", simTime > 0 ? simCycles / simTime : 0.0);
+  stats.count("peak_rss_kb", AigStats::peakRss());
+  stats.perUnit("simulate", "sim_cycle", simCycles);
+  stats.perUnit("simulate", "eval", evaluations);
+
+  if(statsFile.empty())
+    stats.write(cerr);
+  else{
+    ofstream out(statsFile.c_str());
+    if(!out.is_open()){
+      cerr << "Unable to open file " << statsFile << endl;
+      exit(1);
+    }
+    stats.write(out);
+  }
+}
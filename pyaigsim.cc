@@ -0,0 +1,449 @@
+#include <Python.h>
+#include <stdint.h>
+#include "libaigsim.h"
+
+// Python module aigsim on libaigsim.  Stimulus is read from any C
+// contiguous buffer of packed 64 bit words, e.g. a numpy uint64 array,
+// without copying.  Outputs and latches are views of the design's own
+// words, numpy.asarray() of them doesn't copy either.  step() and run()
+// release the GIL.
+
+static PyObject* AigError;
+
+struct DesignObject
+{
+  PyObject_HEAD
+  aigsim* handle;
+  unsigned inputWords;
+  unsigned latchWords;
+  unsigned outputWords;
+  // outputs of the last step and current latch values
+  uint64_t* outputs;
+  uint64_t* latches;
+  // output rows of run() without an outputs buffer
+  uint64_t* rows;
+  Py_ssize_t rowWords;
+  // views exported of rows, it can't move while there are any
+  Py_ssize_t exports;
+  // stepping without the GIL
+  bool busy;
+};
+
+// a view of words of a design, kept alive by the view
+struct WordsObject
+{
+  PyObject_HEAD
+  DesignObject* design;
+  uint64_t* words;
+  bool isRows;
+  int ndim;
+  Py_ssize_t shape[2];
+  Py_ssize_t strides[2];
+};
+
+static PyTypeObject DesignType = { PyVarObject_HEAD_INIT(NULL, 0) };
+static PyTypeObject WordsType = { PyVarObject_HEAD_INIT(NULL, 0) };
+
+/*------------------------------------------------------------------------*/
+
+static PyObject* words_view(DesignObject* design, uint64_t* words, bool isRows, Py_ssize_t rows, Py_ssize_t columns){
+  WordsObject* view;
+  PyObject* result;
+
+  view = PyObject_New(WordsObject, &WordsType);
+  if(!view)
+    return NULL;
+
+  Py_INCREF(design);
+  view->design = design;
+  view->words = words;
+  view->isRows = isRows;
+  view->ndim = isRows ? 2 : 1;
+  view->shape[0] = isRows ? rows : columns;
+  view->shape[1] = columns;
+  view->strides[0] = isRows ? columns * sizeof(uint64_t) : sizeof(uint64_t);
+  view->strides[1] = sizeof(uint64_t);
+
+  result = PyMemoryView_FromObject((PyObject*) view);
+  Py_DECREF(view);
+
+  return result;
+}
+
+static void words_dealloc(WordsObject* self){
+  Py_DECREF(self->design);
+  PyObject_Del(self);
+}
+
+static int words_getbuffer(WordsObject* self, Py_buffer* view, int flags){
+  Py_ssize_t i, len = sizeof(uint64_t);
+
+  if((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE){
+    PyErr_SetString(PyExc_BufferError, "simulator words are read only");
+    view->obj = NULL;
+    return -1;
+  }
+
+  for(i = 0; i < self->ndim; i++)
+    len *= self->shape[i];
+
+  Py_INCREF(self);
+  view->buf = self->words;
+  view->obj = (PyObject*) self;
+  view->len = len;
+  view->readonly = 1;
+  view->itemsize = sizeof(uint64_t);
+  view->format = (flags & PyBUF_FORMAT) ? (char*) "Q" : NULL;
+  view->ndim = self->ndim;
+  view->shape = (flags & PyBUF_ND) ? self->shape : NULL;
+  view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? self->strides : NULL;
+  view->suboffsets = NULL;
+  view->internal = NULL;
+
+  if(self->isRows)
+    self->design->exports++;
+
+  return 0;
+}
+
+static void words_releasebuffer(WordsObject* self, Py_buffer* view){
+  if(self->isRows)
+    self->design->exports--;
+}
+
+static PyBufferProcs words_buffer = { (getbufferproc) words_getbuffer, (releasebufferproc) words_releasebuffer };
+
+/*------------------------------------------------------------------------*/
+
+// C contiguous words of a buffer, at least words of them
+static bool get_words(PyObject* obj, Py_buffer* view, int flags, Py_ssize_t words, const char* name){
+  if(PyObject_GetBuffer(obj, view, flags | PyBUF_C_CONTIGUOUS))
+    return false;
+
+  // nothing is read from an empty array, its pointer may be anywhere
+  if(words && (uintptr_t) view->buf % sizeof(uint64_t)){
+    PyErr_Format(PyExc_ValueError, "%s is not aligned to 64 bit words", name);
+    PyBuffer_Release(view);
+    return false;
+  }
+
+  if(view->len < words * (Py_ssize_t) sizeof(uint64_t)){
+    PyErr_Format(PyExc_ValueError, "%s has %zd words, %zd are needed", name, view->len / (Py_ssize_t) sizeof(uint64_t), words);
+    PyBuffer_Release(view);
+    return false;
+  }
+
+  return true;
+}
+
+static bool check_idle(DesignObject* self){
+  if(self->busy){
+    PyErr_SetString(PyExc_RuntimeError, "design is stepped by another thread");
+    return false;
+  }
+
+  return true;
+}
+
+// after stepping, without the GIL
+static void refresh(DesignObject* self){
+  aigsim_get_outputs(self->handle, self->outputs);
+  aigsim_get_latches(self->handle, self->latches);
+}
+
+/*------------------------------------------------------------------------*/
+
+static PyObject* design_new(PyTypeObject* type, PyObject* args, PyObject* kwds){
+  static const char* keywords[] = { "source", "optimize", NULL };
+  PyObject* source;
+  PyObject* path = NULL;
+  int optimize = 0;
+  char error[128];
+  Py_buffer data;
+  DesignObject* self;
+  aigsim* handle;
+
+  if(!PyArg_ParseTupleAndKeywords(args, kwds, "O|p", (char**) keywords, &source, &optimize))
+    return NULL;
+
+  // a path or the file image
+  if(PyUnicode_Check(source) || PyObject_HasAttrString(source, "__fspath__")){
+    if(!PyUnicode_FSConverter(source, &path))
+      return NULL;
+
+    Py_BEGIN_ALLOW_THREADS
+    handle = aigsim_open_file(PyBytes_AS_STRING(path), optimize ? AIGSIM_OPTIMIZE : 0, error, sizeof(error));
+    Py_END_ALLOW_THREADS
+    Py_DECREF(path);
+  }
+  else{
+    if(PyObject_GetBuffer(source, &data, PyBUF_SIMPLE))
+      return NULL;
+
+    Py_BEGIN_ALLOW_THREADS
+    handle = aigsim_open_memory(data.buf, data.len, optimize ? AIGSIM_OPTIMIZE : 0, error, sizeof(error));
+    Py_END_ALLOW_THREADS
+    PyBuffer_Release(&data);
+  }
+
+  if(!handle){
+    PyErr_SetString(AigError, error);
+    return NULL;
+  }
+
+  self = (DesignObject*) type->tp_alloc(type, 0);
+  if(!self){
+    aigsim_close(handle);
+    return NULL;
+  }
+
+  self->handle = handle;
+  self->inputWords = AIGSIM_WORDS(aigsim_num_inputs(handle));
+  self->latchWords = AIGSIM_WORDS(aigsim_num_latches(handle));
+  self->outputWords = AIGSIM_WORDS(aigsim_num_outputs(handle));
+  self->outputs = (uint64_t*) PyMem_Calloc(self->outputWords + 1, sizeof(uint64_t));
+  self->latches = (uint64_t*) PyMem_Calloc(self->latchWords + 1, sizeof(uint64_t));
+  self->rows = NULL;
+  self->rowWords = 0;
+  self->exports = 0;
+  self->busy = false;
+
+  if(!self->outputs || !self->latches){
+    Py_DECREF(self);
+    return PyErr_NoMemory();
+  }
+
+  return (PyObject*) self;
+}
+
+static void design_dealloc(DesignObject* self){
+  aigsim_close(self->handle);
+  PyMem_Free(self->outputs);
+  PyMem_Free(self->latches);
+  PyMem_Free(self->rows);
+  Py_TYPE(self)->tp_free((PyObject*) self);
+}
+
+static PyObject* design_reset(DesignObject* self, PyObject* unused){
+  if(!check_idle(self))
+    return NULL;
+
+  aigsim_reset(self->handle);
+  refresh(self);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject* design_set_inputs(DesignObject* self, PyObject* obj){
+  Py_buffer view;
+
+  if(!check_idle(self) || !get_words(obj, &view, PyBUF_SIMPLE, self->inputWords, "inputs"))
+    return NULL;
+
+  aigsim_set_inputs(self->handle, (const uint64_t*) view.buf);
+  PyBuffer_Release(&view);
+
+  Py_RETURN_NONE;
+}
+
+static PyObject* design_step(DesignObject* self, PyObject* args){
+  unsigned long long cycles = 1;
+
+  if(!PyArg_ParseTuple(args, "|K", &cycles) || !check_idle(self))
+    return NULL;
+
+  self->busy = true;
+  Py_BEGIN_ALLOW_THREADS
+  aigsim_step(self->handle, cycles);
+  refresh(self);
+  Py_END_ALLOW_THREADS
+  self->busy = false;
+
+  Py_RETURN_NONE;
+}
+
+// Steps a row of inputs per cycle, by default as many as there are rows.
+// The output rows go to outputs, or to the design's own buffer which is
+// returned as a view and overwritten by the next run.
+static PyObject* design_run(DesignObject* self, PyObject* args, PyObject* kwds){
+  static const char* keywords[] = { "inputs", "cycles", "outputs", "latches", NULL };
+  PyObject* inputsObj;
+  PyObject* cyclesObj = Py_None;
+  PyObject* outputsObj = Py_None;
+  PyObject* latchesObj = Py_None;
+  Py_ssize_t cycles = -1;
+  Py_ssize_t words;
+  Py_buffer inputs, outputs, latches;
+  uint64_t* rows;
+
+  if(!PyArg_ParseTupleAndKeywords(args, kwds, "O|OOO", (char**) keywords, &inputsObj, &cyclesObj, &outputsObj, &latchesObj) || !check_idle(self))
+    return NULL;
+
+  if(cyclesObj != Py_None){
+    cycles = PyNumber_AsSsize_t(cyclesObj, PyExc_OverflowError);
+    if(cycles < 0){
+      if(!PyErr_Occurred())
+        PyErr_SetString(PyExc_ValueError, "cycles is negative");
+      return NULL;
+    }
+  }
+
+  if(cycles < 0 && !self->inputWords){
+    PyErr_SetString(PyExc_ValueError, "cycles is needed for a design without inputs");
+    return NULL;
+  }
+
+  if(cycles < 0){
+    if(PyObject_GetBuffer(inputsObj, &inputs, PyBUF_C_CONTIGUOUS))
+      return NULL;
+    cycles = inputs.len / sizeof(uint64_t) / self->inputWords;
+    PyBuffer_Release(&inputs);
+  }
+
+  // the row sizes below can't overflow
+  words = self->inputWords > self->outputWords ? self->inputWords : self->outputWords;
+  words = words > self->latchWords ? words : self->latchWords;
+  if(words && cycles > PY_SSIZE_T_MAX / (Py_ssize_t) sizeof(uint64_t) / words){
+    PyErr_SetString(PyExc_OverflowError, "cycles is too large");
+    return NULL;
+  }
+
+  if(!get_words(inputsObj, &inputs, PyBUF_SIMPLE, cycles * self->inputWords, "inputs"))
+    return NULL;
+
+  outputs.obj = NULL;
+  latches.obj = NULL;
+  if(outputsObj != Py_None && !get_words(outputsObj, &outputs, PyBUF_WRITABLE, cycles * self->outputWords, "outputs"))
+    goto fail;
+  if(latchesObj != Py_None && !get_words(latchesObj, &latches, PyBUF_WRITABLE, cycles * self->latchWords, "latches"))
+    goto fail;
+
+  if(outputs.obj)
+    rows = (uint64_t*) outputs.buf;
+  else{
+    words = cycles * self->outputWords;
+    if(words > self->rowWords){
+      if(self->exports){
+        PyErr_SetString(PyExc_BufferError, "output rows of the last run are still in use, pass outputs");
+        goto fail;
+      }
+
+      rows = (uint64_t*) PyMem_Realloc(self->rows, words * sizeof(uint64_t));
+      if(!rows){
+        PyErr_NoMemory();
+        goto fail;
+      }
+      self->rows = rows;
+      self->rowWords = words;
+    }
+    rows = self->rows;
+  }
+
+  self->busy = true;
+  Py_BEGIN_ALLOW_THREADS
+  aigsim_run(self->handle, (const uint64_t*) inputs.buf, cycles, rows, latches.obj ? (uint64_t*) latches.buf : NULL);
+  refresh(self);
+  Py_END_ALLOW_THREADS
+  self->busy = false;
+
+  PyBuffer_Release(&inputs);
+  if(latches.obj)
+    PyBuffer_Release(&latches);
+
+  if(outputs.obj){
+    PyBuffer_Release(&outputs);
+    Py_INCREF(outputsObj);
+    return outputsObj;
+  }
+
+  return words_view(self, self->rows, true, cycles, self->outputWords);
+
+fail:
+  PyBuffer_Release(&inputs);
+  if(outputs.obj)
+    PyBuffer_Release(&outputs);
+  if(latches.obj)
+    PyBuffer_Release(&latches);
+  return NULL;
+}
+
+static PyObject* design_get_outputs(DesignObject* self, void* closure){
+  return words_view(self, self->outputs, false, 1, self->outputWords);
+}
+
+static PyObject* design_get_latches(DesignObject* self, void* closure){
+  return words_view(self, self->latches, false, 1, self->latchWords);
+}
+
+// closure is 0 for inputs, 1 for latches and 2 for outputs
+static PyObject* design_get_count(DesignObject* self, void* closure){
+  switch((intptr_t) closure){
+  case 0:
+    return PyLong_FromUnsignedLong(aigsim_num_inputs(self->handle));
+  case 1:
+    return PyLong_FromUnsignedLong(aigsim_num_latches(self->handle));
+  default:
+    return PyLong_FromUnsignedLong(aigsim_num_outputs(self->handle));
+  }
+}
+
+static PyMethodDef design_methods[] = {
+  { "reset", (PyCFunction) design_reset, METH_NOARGS, "Latches, inputs and outputs back to 0." },
+  { "set_inputs", (PyCFunction) design_set_inputs, METH_O, "Inputs of the following steps as packed 64 bit words." },
+  { "step", (PyCFunction) design_step, METH_VARARGS, "step(cycles=1), the GIL is released." },
+  { "run", (PyCFunction) design_run, METH_VARARGS | METH_KEYWORDS,
+    "run(inputs, cycles=rows of inputs, outputs=None, latches=None)\n\n"
+    "Steps a row of packed inputs per cycle and returns a row of packed\n"
+    "outputs per cycle, the GIL is released.  Without outputs the rows are\n"
+    "a view of the design's buffer, valid until the next run.  latches\n"
+    "gets the latch values each cycle started with." },
+  { NULL, NULL, 0, NULL }
+};
+
+static PyGetSetDef design_getset[] = {
+  { (char*) "outputs", (getter) design_get_outputs, NULL, (char*) "view of the outputs of the last step", NULL },
+  { (char*) "latches", (getter) design_get_latches, NULL, (char*) "view of the current latch values", NULL },
+  { (char*) "num_inputs", (getter) design_get_count, NULL, NULL, (void*) 0 },
+  { (char*) "num_latches", (getter) design_get_count, NULL, NULL, (void*) 1 },
+  { (char*) "num_outputs", (getter) design_get_count, NULL, NULL, (void*) 2 },
+  { NULL, NULL, NULL, NULL, NULL }
+};
+
+/*------------------------------------------------------------------------*/
+
+static PyModuleDef aigsim_module = { PyModuleDef_HEAD_INIT, "aigsim", "Cycle simulation of aiger designs.", -1, NULL };
+
+PyMODINIT_FUNC PyInit_aigsim(void){
+  PyObject* module;
+
+  DesignType.tp_name = "aigsim.Design";
+  DesignType.tp_basicsize = sizeof(DesignObject);
+  DesignType.tp_flags = Py_TPFLAGS_DEFAULT;
+  DesignType.tp_doc = "Design(source, optimize=False)\n\nAn aiger design loaded from a path, or from the bytes of an\nuncompressed file.";
+  DesignType.tp_new = design_new;
+  DesignType.tp_dealloc = (destructor) design_dealloc;
+  DesignType.tp_methods = design_methods;
+  DesignType.tp_getset = design_getset;
+
+  WordsType.tp_name = "aigsim.Words";
+  WordsType.tp_basicsize = sizeof(WordsObject);
+  WordsType.tp_flags = Py_TPFLAGS_DEFAULT;
+  WordsType.tp_dealloc = (destructor) words_dealloc;
+  WordsType.tp_as_buffer = &words_buffer;
+
+  if(PyType_Ready(&DesignType) < 0 || PyType_Ready(&WordsType) < 0)
+    return NULL;
+
+  module = PyModule_Create(&aigsim_module);
+  if(!module)
+    return NULL;
+
+  AigError = PyErr_NewException("aigsim.error", NULL, NULL);
+  Py_INCREF(&DesignType);
+  if(!AigError || PyModule_AddObject(module, "error", AigError) || PyModule_AddObject(module, "Design", (PyObject*) &DesignType)){
+    Py_DECREF(module);
+    return NULL;
+  }
+
+  return module;
+}
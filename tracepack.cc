@@ -0,0 +1,68 @@
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include "aigtrace.h"
+#include "aigout.h"
+
+#define TRACEPACK_USAGE \
+"\n" \
+"usage: tracepack [-h][-u] src dst \n" \
+"\n" \
+"  -h     print this command line option summary\n" \
+"  -u     unpack, src is a packed trace or packed sim output and dst text\n" \
+"  src    text trace or sim output file, only the input column is packed\n" \
+"  dst    packed trace file\n" \
+"\n"
+
+int main(int argc, char *argv[])
+{
+  bool unpack = false;
+  bool ok;
+  string srcFile;
+  string dstFile;
+  string error;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (!strcmp (argv[i], "-h"))
+    {
+      cerr << TRACEPACK_USAGE << endl;
+      exit (0);
+    }
+    else if(!strcmp(argv[i], "-u"))
+      unpack = true;
+    else if (argv[i][0] == '-'){
+      cerr << "[tracepack.cc main] invalid command line option " << argv[i] << endl;
+      cerr << TRACEPACK_USAGE << endl;
+      exit (1);
+    }
+    else if(srcFile.empty())
+      srcFile = argv[i];
+    else if(dstFile.empty())
+      dstFile = argv[i];
+    else{
+      cerr << TRACEPACK_USAGE << endl;
+      exit (1);
+    }
+  }
+
+  if(dstFile.empty()){
+    cerr << TRACEPACK_USAGE << endl;
+    exit (1);
+  }
+
+  if(!unpack)
+    ok = AigTrace::pack(srcFile, dstFile, error);
+  else if(AigOutput::isPacked(srcFile))
+    ok = AigOutput::unpack(srcFile, dstFile, error);
+  else
+    ok = AigTrace::unpack(srcFile, dstFile, error);
+
+  if(!ok){
+    cerr << error << endl;
+    exit(1);
+  }
+
+  return 0;
+}